@@ -8,7 +8,7 @@ using namespace phoenix;
 int main()
 {
     /*Extract Data*/
-    auto input_data = ReadFileToMatrix("/home/ml/Desktop/Phoenix-ML/examples/semeoin.data", ' ');
+    auto input_data = ReadFileToMatrix<float>("/home/ml/Desktop/Phoenix-ML/examples/semeoin.data", ' ');
 
     ShuffleMatrixRows(input_data, 0.5);
 
@@ -31,7 +31,7 @@ int main()
     auto actual_label = convert_row(Y_test, 1);
 
     /*Load NN Model*/
-    SimpleNeuralNetwork nn;
+    SimpleNeuralNetwork<float> nn;
     nn.load("mymodel.nn");
 
     auto predicted_label = nn.predict(actual_feature);
@@ -0,0 +1,57 @@
+#include <iostream>
+#include "nnet/ModelSearch.h"
+#include "io.h"
+#include "utils.h"
+
+using namespace phoenix;
+
+int main()
+{
+    /*Extract Data, once for every configuration of the sweep*/
+    auto input_data = ReadFileToMatrix<float>("/home/ml/Desktop/Phoenix-ML/examples/semeoin.data", ' ');
+
+    ShuffleMatrixRows(input_data, 0.5);
+
+    std::vector<int> feature_mark;
+    std::vector<int> label_mark;
+    for (int i = 0; i < input_data.getCols() - 10; i++)
+    {
+        feature_mark.push_back(i);
+    }
+
+    for (int i = 256; i < input_data.getCols(); i++)
+    {
+        label_mark.push_back(i);
+    }
+    auto feature_data = SetMatrix(input_data, feature_mark);
+    auto label_data = SetMatrix(input_data, label_mark);
+
+    /*Split into Training and Validation Data*/
+    auto [X_train, X_test, Y_train, Y_test] = train_test_split(feature_data, label_data, 0.75);
+
+    /*Sweep hidden layers, learning rates and activations*/
+    ModelSearch<float> search(X_train, Y_train, X_test, Y_test);
+    for (double rate : {0.001, 0.01, 0.1})
+    {
+        for (std::vector<int> hidden : {std::vector<int>{50}, std::vector<int>{100}, std::vector<int>{100, 50}})
+        {
+            for (std::string act : {"sigmoid", "tanh", "relu"})
+            {
+                SearchConfig config;
+                config.hidden = hidden;
+                config.learning_rate = rate;
+                config.activations.assign(hidden.size(), act);
+                config.activations.push_back("softmax");
+                search.add(config);
+            }
+        }
+    }
+
+    /*27 models get 1 epoch, the best 9 get 3, the best 3 get 9 and the winner 50*/
+    search.run(1, 50, 3);
+    search.save("mymodel.nn");
+
+    std::cout << "Validation accuracy: " << search.best().accuracy(X_test, Y_test) << std::endl;
+
+    return 1;
+}
@@ -0,0 +1,40 @@
+#include <iostream>
+#include "nnet/StaticNetwork.h"
+#include "io.h"
+#include "utils.h"
+
+using namespace phoenix;
+
+/*256-100-10 float classifier saved by nntrain, shapes fixed at compile time*/
+static BasicStaticNetwork<float, activation::sigmoid, activation::linear, 256, 100, 10> nn;
+
+int main()
+{
+    /*Extract Data*/
+    auto input_data = ReadFileToMatrix<float>("/home/ml/Desktop/Phoenix-ML/examples/semeoin.data", ' ');
+
+    std::vector<int> feature_mark;
+    std::vector<int> label_mark;
+    for (int i = 0; i < input_data.getCols() - 10; i++)
+    {
+        feature_mark.push_back(i);
+    }
+    for (int i = 256; i < input_data.getCols(); i++)
+    {
+        label_mark.push_back(i);
+    }
+    auto feature_data = SetMatrix(input_data, feature_mark);
+    auto label_data = SetMatrix(input_data, label_mark);
+
+    /*Load NN Model*/
+    nn.load("mymodel.nn");
+
+    auto predicted_label = nn.predict(feature_data.row(1));
+
+    for (float value : predicted_label)
+        std::cout << value << std::endl;
+    std::cout << std::endl;
+    std::cout << convert_row(label_data, 1) << std::endl;
+
+    return 1;
+}
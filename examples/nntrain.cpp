@@ -8,7 +8,7 @@ using namespace phoenix;
 int main()
 {
     /*Extract Data*/
-    auto input_data = ReadFileToMatrix("/home/ml/Desktop/Phoenix-ML/examples/semeoin.data", ' ');
+    auto input_data = ReadFileToMatrix<float>("/home/ml/Desktop/Phoenix-ML/examples/semeoin.data", ' ');
 
 
     ShuffleMatrixRows(input_data, 0.5);
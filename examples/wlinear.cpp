@@ -87,7 +87,7 @@ class Wlinear
         }
 
     public:
-        INeuralNetwork* my_model;
+        INeuralNetwork<>* my_model;
         Matrix<double> X;
         Matrix<double> y;
         Matrix<double> predicted;
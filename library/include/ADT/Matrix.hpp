@@ -12,6 +12,10 @@
 #include <initializer_list>
 #include <vector>
 #include <cmath>
+#include "allocator.hpp"
+#include "gemm.h"
+#include "random.h"
+#include "view.hpp"
 
 namespace phoenix {
 
@@ -32,14 +36,15 @@ class Matrix
 {
 
 private:
-    /**
-     * @brief Unique pointer to the data stored in the matrix
-     */
-
     int rows;
     int cols;
 
 private:
+    /**
+     * @brief Shared pointer to the data stored in the matrix
+     *        \n The buffer is 64-byte aligned and comes from the storage policy that was
+     *        \n current on the constructing thread (see allocator.hpp).
+     */
     std::shared_ptr<T[]> data;
 
 public:
@@ -48,7 +53,7 @@ public:
      * @param r row index for matrix elements
      * @param c col index for matrix elements
      */
-    Matrix(int r, int c = 1) : rows(r), cols(c), data(std::make_unique<T[]>(r * c))
+    Matrix(int r, int c = 1) : rows(r), cols(c), data(allocate_storage<T>(r * c))
     {
     }
 
@@ -56,7 +61,17 @@ public:
      * @brief Default Matrix object constructor.
      *
      */
-    Matrix() : rows(1), cols(1), data(std::make_unique<T[]>(1))
+    Matrix() : rows(1), cols(1), data(allocate_storage<T>(1))
+    {
+    }
+
+    /**
+     * @brief Constructs a r x c matrix on elements of a buffer owned by storage, starting at first.
+     *        \n Nothing is allocated or copied, the matrix shares ownership of the buffer.
+     * @param storage The buffer the elements belong to.
+     * @param first Pointer to element (0, 0) inside the buffer.
+     */
+    Matrix(const std::shared_ptr<T[]> &storage, T *first, int r, int c = 1) : rows(r), cols(c), data(storage, first)
     {
     }
 
@@ -168,6 +183,59 @@ public:
      */
     T *getdata() { return data.get(); }
 
+    /**
+     * @brief Get a pointer to the raw data stored in the matrix(read-only).
+     * @return A pointer to the raw data stored in the matrix.
+     */
+    const T *getdata() const { return data.get(); }
+
+    /**
+     * @brief Returns a view on the whole matrix (mutable).
+     */
+    MatrixView<T> view() { return MatrixView<T>(data.get(), rows, cols, cols); }
+
+    /**
+     * @brief Returns a view on the whole matrix (read-only).
+     */
+    MatrixView<const T> view() const { return MatrixView<const T>(data.get(), rows, cols, cols); }
+
+    /**
+     * @brief Implicit conversion to a view on the whole matrix.
+     */
+    operator MatrixView<T>() { return view(); }
+    operator MatrixView<const T>() const { return view(); }
+
+    /**
+     * @brief Returns a view on row i without copying it (mutable).
+     * @throws std::invalid_argument if i is out of range.
+     */
+    VectorView<T> row(int i) { return view().row(i); }
+
+    /**
+     * @brief Returns a view on row i without copying it (read-only).
+     * @throws std::invalid_argument if i is out of range.
+     */
+    VectorView<const T> row(int i) const { return view().row(i); }
+
+    /**
+     * @brief Returns a strided view on column j without copying it (mutable).
+     * @throws std::invalid_argument if j is out of range.
+     */
+    VectorView<T> col(int j) { return view().col(j); }
+
+    /**
+     * @brief Returns a strided view on column j without copying it (read-only).
+     * @throws std::invalid_argument if j is out of range.
+     */
+    VectorView<const T> col(int j) const { return view().col(j); }
+
+    /**
+     * @brief Returns a view on the nr x nc block whose top left element is (r, c).
+     * @throws std::invalid_argument if the block is outside the matrix.
+     */
+    MatrixView<T> block(int r, int c, int nr, int nc) { return view().block(r, c, nr, nc); }
+    MatrixView<const T> block(int r, int c, int nr, int nc) const { return view().block(r, c, nr, nc); }
+
     /**
      * @brief Get the total number of element in a matrix
      * @return the total size of the matric given by row multiply by col
@@ -229,18 +297,13 @@ public:
     }
 
     /**
-    * @brief Fills the matrix with random values between 0 and 1 using the srand function with seed value 2.
+    * @brief Fills the matrix with random values in [0, 1) from stream 0 of the seed value 2.
+    *        \n Every call gives the same values and is safe to run on several threads at once.
     */
     void randfill()
     {
-        double d_rand;
-        srand(2);
-        for (int i = 0; i < size(); i++)
-        {
-            d_rand = (rand() % 10);
-            d_rand /= 10;
-            data[i] = d_rand;
-        }
+        RandomStream stream(2);
+        stream.uniform(data.get(), size());
     }
 
     /**
@@ -281,24 +344,24 @@ public:
 
     /**
      * @brief Multiplies two matrices and returns the result.
+     *       \n The product is computed by the cache-blocked kernel in gemm.h.
      *
      * @param other The matrix to multiply with.
      * @return The result of the matrix multiplication.
+     * @throws std::invalid_argument if the number of columns does not match the rows of other.
      */
     Matrix<T> operator*(const Matrix &other) const
     {
-        Matrix<T> result(getRows(), other.getCols());
-        for (int i = 0; i < getRows(); i++)
+        if (getCols() != other.getRows())
         {
-            for (int j = 0; j < other.getCols(); j++)
-            {
-                result[i][j] = 0;
-                for (int k = 0; k < getCols(); k++)
-                {
-                    result[i][j] += (*this)[i][k] * other[k][j];
-                }
-            }
+            throw std::invalid_argument("The number of matrix columns must be equal to other matrix rows. ");
         }
+
+        Matrix<T> result(getRows(), other.getCols());
+        gemm(getRows(), other.getCols(), getCols(), T(1),
+             data.get(), getCols(), 1,
+             other.data.get(), other.getCols(), 1,
+             T(0), result.data.get(), result.getCols(), 1);
         return result;
     }
 
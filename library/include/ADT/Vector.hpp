@@ -9,6 +9,7 @@
 #include <config.hpp>
 #include "Matrix.hpp"
 #include "parallel.h"
+#include "expression.hpp"
 
 
 namespace phoenix {
@@ -36,6 +37,39 @@ public:
         v_size = size;
     }
 
+    /**
+     * @brief Constructs a vector on size elements of a buffer owned by storage, starting at first.
+     *        \n Nothing is allocated or copied, the vector shares ownership of the buffer.
+     */
+    Vector(const std::shared_ptr<T[]> &storage, T *first, int size)
+        : Matrix<T>(storage, first, size, 1)
+    {
+        v_size = size;
+    }
+
+    /**
+     * @brief Constructs a vector holding the value of an expression, evaluated in one pass.
+     *
+     * @param expr Expression built from views, e.g. W.view() * x + b.
+     */
+    template <typename E>
+    Vector(const VecExpr<E> &expr)
+        : Matrix<T>(expr.self().size(), 1)
+    {
+        v_size = expr.self().size();
+        assign(VectorView<T>(this->getdata(), v_size), expr);
+    }
+
+    /**
+     * @brief Implicit conversion to a view on the vector elements (mutable).
+     */
+    operator VectorView<T>() { return VectorView<T>(this->getdata(), v_size); }
+
+    /**
+     * @brief Implicit conversion to a view on the vector elements (read-only).
+     */
+    operator VectorView<const T>() const { return VectorView<const T>(this->getdata(), v_size); }
+
     /**
      * @brief Overloaded bracket operator to accesses vector element at index i.
      *
@@ -124,7 +158,7 @@ public:
     Vector<T> result(other.size());
 
     if (enable_parallel)
-        vector_vector_add(v, other, result, boost::thread::hardware_concurrency());
+        vector_vector_add(v, other, result, ThreadPool::instance().size());
     else
         vector_vector_add(v, other, result);
 
@@ -180,10 +214,10 @@ public:
             throw std::invalid_argument("The number of vector rows must be equal to Matrix column. ");
         }
 
-        Vector<double> result(m2.getRows());
+        Vector<T> result(m2.getRows());
 
         if (enable_parallel)
-            matrix_vector_multiply(m2, v1, result, boost::thread::hardware_concurrency());
+            matrix_vector_multiply(m2, v1, result, ThreadPool::instance().size());
         else
             matrix_vector_multiply(m2, v1, result);
 
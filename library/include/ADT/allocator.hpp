@@ -0,0 +1,167 @@
+/**
+ * @file allocator.hpp
+ * @brief Storage policies used by the Matrix class to obtain its element buffer.
+ */
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace phoenix {
+
+/**
+ * @brief Alignment in bytes of every buffer handed out by a storage policy.
+ */
+constexpr std::size_t storage_alignment = 64;
+
+/**
+ * @brief Interface of a source of raw, storage_alignment aligned memory for matrices.
+ *        \n Each thread has a current policy (the aligned heap by default) that every
+ *        \n Matrix constructed on that thread allocates from; see StorageScope.
+ */
+class StoragePolicy
+{
+public:
+    virtual ~StoragePolicy() = default;
+
+    /**
+     * @brief Allocates bytes of storage_alignment aligned memory.
+     * @param bytes Number of bytes requested.
+     * @return Pointer to the block.
+     * @throws std::bad_alloc if the memory cannot be obtained.
+     */
+    virtual void *allocate(std::size_t bytes) = 0;
+
+    /**
+     * @brief Returns a block obtained from allocate.
+     * @param block Pointer returned by allocate.
+     * @param bytes Size that was passed to allocate.
+     */
+    virtual void deallocate(void *block, std::size_t bytes) noexcept = 0;
+};
+
+/**
+ * @brief Storage policy backed by the aligned global operator new.
+ */
+class AlignedHeap : public StoragePolicy
+{
+public:
+    /**
+     * @brief Returns the process wide aligned heap.
+     */
+    static AlignedHeap &instance();
+
+    void *allocate(std::size_t bytes) override;
+    void deallocate(void *block, std::size_t bytes) noexcept override;
+};
+
+/**
+ * @brief Returns the storage policy matrices on the calling thread allocate from.
+ */
+StoragePolicy &current_storage();
+
+/**
+ * @brief RAII guard that makes a storage policy current on the calling thread.
+ */
+class StorageScope
+{
+public:
+    /**
+     * @brief Makes policy current until the scope ends.
+     * @param policy Storage policy for matrices constructed inside the scope.
+     */
+    explicit StorageScope(StoragePolicy &policy);
+
+    /**
+     * @brief Restores the previously current policy.
+     */
+    ~StorageScope();
+
+    StorageScope(const StorageScope &) = delete;
+    StorageScope &operator=(const StorageScope &) = delete;
+
+private:
+    StoragePolicy *previous_;
+};
+
+/**
+ * @brief Standard allocator adaptor over a storage policy, used for shared_ptr control blocks.
+ */
+template <typename U>
+struct StorageAllocator
+{
+    using value_type = U;
+
+    StoragePolicy *policy;
+
+    explicit StorageAllocator(StoragePolicy *p) : policy(p) {}
+
+    template <typename V>
+    StorageAllocator(const StorageAllocator<V> &other) : policy(other.policy) {}
+
+    U *allocate(std::size_t n) { return static_cast<U *>(policy->allocate(n * sizeof(U))); }
+    void deallocate(U *p, std::size_t n) noexcept { policy->deallocate(p, n * sizeof(U)); }
+
+    template <typename V>
+    bool operator==(const StorageAllocator<V> &other) const { return policy == other.policy; }
+    template <typename V>
+    bool operator!=(const StorageAllocator<V> &other) const { return policy != other.policy; }
+};
+
+/**
+ * @brief Deleter that destroys the elements and returns the block to its policy.
+ */
+template <typename T>
+struct StorageDeleter
+{
+    StoragePolicy *policy;
+    std::size_t count;
+
+    void operator()(T *p) const noexcept
+    {
+        std::destroy_n(p, count);
+        policy->deallocate(p, count * sizeof(T));
+    }
+};
+
+/**
+ * @brief Allocates n value initialised elements from the current storage policy.
+ *
+ * @param n Number of elements.
+ * @return A shared buffer whose block and control block both come from the policy.
+ * @tparam T Type of the elements.
+ */
+template <typename T>
+std::shared_ptr<T[]> allocate_storage(std::size_t n)
+{
+    StoragePolicy &policy = current_storage();
+    T *p = static_cast<T *>(policy.allocate(n * sizeof(T)));
+
+    if constexpr (std::is_trivially_default_constructible_v<T>)
+    {
+        std::memset(static_cast<void *>(p), 0, n * sizeof(T));
+    }
+    else
+    {
+        try
+        {
+            std::uninitialized_value_construct_n(p, n);
+        }
+        catch (...)
+        {
+            policy.deallocate(p, n * sizeof(T));
+            throw;
+        }
+    }
+
+    return std::shared_ptr<T[]>(p, StorageDeleter<T>{&policy, n}, StorageAllocator<char>(&policy));
+}
+
+}
+
+#endif // ALLOCATOR_H
@@ -0,0 +1,330 @@
+/**
+ * @file expression.hpp
+ * @brief Expression templates for fused element-wise arithmetic on vector views.
+ *
+ *  \n Arithmetic on a VectorView, a MatrixView (or a Matrix times a view) does not compute
+ *  \n anything, it builds a small expression object that describes the result. The
+ *  \n expression is evaluated element by element into its destination by assign() or
+ *  \n add_assign(), so a chain such as an activation of (W * x + b) runs as one pass with
+ *  \n no intermediate vector. Arithmetic between two Vector objects stays eager.
+ */
+
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <config.hpp>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include "view.hpp"
+#include "simd.h"
+#include "threadpool.h"
+
+namespace phoenix {
+
+template <typename T>
+class Matrix;
+
+template <typename T>
+class Vector;
+
+/**
+ * @brief Base class of every vector expression (CRTP).
+ *
+ * @tparam E The concrete expression type, it provides size(), cost() and operator[].
+ */
+template <typename E>
+struct VecExpr
+{
+    const E &self() const { return static_cast<const E &>(*this); }
+};
+
+/**
+ * @brief Leaf expression reading a vector view.
+ */
+template <typename T>
+class ViewExpr : public VecExpr<ViewExpr<T>>
+{
+    VectorView<const T> v;
+
+public:
+    using value_type = T;
+
+    explicit ViewExpr(VectorView<const T> view) : v(view) {}
+
+    int size() const { return v.size(); }
+    std::size_t cost() const { return 1; }
+    T operator[](int i) const { return v[i]; }
+};
+
+/**
+ * @brief Element-wise binary expression, op(l[i], r[i]).
+ */
+template <typename L, typename R, typename Op>
+class BinaryExpr : public VecExpr<BinaryExpr<L, R, Op>>
+{
+    L l;
+    R r;
+
+public:
+    using value_type = typename L::value_type;
+
+    BinaryExpr(const L &left, const R &right) : l(left), r(right)
+    {
+        if (l.size() != r.size())
+        {
+            throw std::invalid_argument("The number of vector rows must be equal in vector expression. ");
+        }
+    }
+
+    int size() const { return l.size(); }
+    std::size_t cost() const { return l.cost() + r.cost(); }
+    value_type operator[](int i) const { return Op()(l[i], r[i]); }
+};
+
+/**
+ * @brief Scaled expression, s * e[i].
+ */
+template <typename E>
+class ScaleExpr : public VecExpr<ScaleExpr<E>>
+{
+    using T = typename E::value_type;
+
+    T s;
+    E e;
+
+public:
+    using value_type = T;
+
+    ScaleExpr(T scalar, const E &expr) : s(scalar), e(expr) {}
+
+    int size() const { return e.size(); }
+    std::size_t cost() const { return e.cost(); }
+    T operator[](int i) const { return s * e[i]; }
+};
+
+/**
+ * @brief Expression applying a unary function to every element, f(e[i]).
+ *
+ * @tparam F Callable type, stored by value; wrap a std::function in std::cref to avoid a copy.
+ */
+template <typename E, typename F>
+class MapExpr : public VecExpr<MapExpr<E, F>>
+{
+    using T = typename E::value_type;
+
+    E e;
+    F f;
+
+public:
+    using value_type = T;
+
+    MapExpr(const E &expr, F fn) : e(expr), f(fn) {}
+
+    int size() const { return e.size(); }
+    std::size_t cost() const { return e.cost() + 4; }
+    T operator[](int i) const { return static_cast<T>(f(e[i])); }
+};
+
+/**
+ * @brief Matrix vector product expression, element i is the dot product of row i with x.
+ */
+template <typename T>
+class GemvExpr : public VecExpr<GemvExpr<T>>
+{
+    MatrixView<const T> m;
+    VectorView<const T> x;
+
+public:
+    using value_type = T;
+
+    GemvExpr(MatrixView<const T> matrix, VectorView<const T> vector) : m(matrix), x(vector)
+    {
+        if (x.size() != m.getCols())
+        {
+            throw std::invalid_argument("The number of vector rows must be equal to Matrix column. ");
+        }
+    }
+
+    int size() const { return m.getRows(); }
+    std::size_t cost() const { return static_cast<std::size_t>(m.getCols()) + 1; }
+
+    T operator[](int i) const
+    {
+        if (m.contiguousRows() && x.contiguous())
+            return simd::dot(m.data() + i * m.rowStride(), x.data(), m.getCols());
+
+        T sum = 0;
+        for (int j = 0; j < m.getCols(); j++)
+        {
+            sum += m(i, j) * x[j];
+        }
+        return sum;
+    }
+};
+
+namespace detail {
+
+template <typename T>
+struct is_lazy : std::false_type {};
+template <typename T>
+struct is_lazy<VectorView<T>> : std::true_type {};
+
+template <typename T>
+struct is_vector : std::false_type {};
+template <typename T>
+struct is_vector<Vector<T>> : std::true_type {};
+
+template <typename T>
+constexpr bool is_expr_v = std::is_base_of_v<VecExpr<T>, T>;
+
+template <typename T>
+constexpr bool is_lazy_v = is_expr_v<T> || is_lazy<T>::value;
+
+template <typename T>
+constexpr bool is_operand_v = is_lazy_v<T> || is_vector<T>::value;
+
+template <typename E, typename = std::enable_if_t<is_expr_v<E>>>
+const E &as_expr(const E &e) { return e; }
+
+template <typename T>
+ViewExpr<std::remove_const_t<T>> as_expr(const VectorView<T> &v)
+{
+    return ViewExpr<std::remove_const_t<T>>(VectorView<const std::remove_const_t<T>>(v));
+}
+
+template <typename T>
+ViewExpr<T> as_expr(const Vector<T> &v) { return ViewExpr<T>(VectorView<const T>(v)); }
+
+template <typename T>
+using expr_t = std::decay_t<decltype(as_expr(std::declval<const T &>()))>;
+
+template <typename L, typename R>
+constexpr bool lazy_pair_v = is_operand_v<L> && is_operand_v<R> && (is_lazy_v<L> || is_lazy_v<R>);
+
+}
+
+/**
+ * @brief Lazy element-wise sum of two operands, at least one of them a view or an expression.
+ */
+template <typename L, typename R, typename = std::enable_if_t<detail::lazy_pair_v<L, R>>>
+auto operator+(const L &l, const R &r)
+{
+    return BinaryExpr<detail::expr_t<L>, detail::expr_t<R>, std::plus<>>(detail::as_expr(l), detail::as_expr(r));
+}
+
+/**
+ * @brief Lazy element-wise difference of two operands, at least one of them a view or an expression.
+ */
+template <typename L, typename R, typename = std::enable_if_t<detail::lazy_pair_v<L, R>>>
+auto operator-(const L &l, const R &r)
+{
+    return BinaryExpr<detail::expr_t<L>, detail::expr_t<R>, std::minus<>>(detail::as_expr(l), detail::as_expr(r));
+}
+
+/**
+ * @brief Lazy element-wise (Hadamard) product of two operands, at least one of them a view or an expression.
+ */
+template <typename L, typename R, typename = std::enable_if_t<detail::lazy_pair_v<L, R>>>
+auto operator*(const L &l, const R &r)
+{
+    return BinaryExpr<detail::expr_t<L>, detail::expr_t<R>, std::multiplies<>>(detail::as_expr(l), detail::as_expr(r));
+}
+
+/**
+ * @brief Lazy product of a scalar with a view or an expression.
+ */
+template <typename E, typename = std::enable_if_t<detail::is_lazy_v<E>>>
+auto operator*(typename detail::expr_t<E>::value_type s, const E &e)
+{
+    return ScaleExpr<detail::expr_t<E>>(s, detail::as_expr(e));
+}
+
+/**
+ * @brief Lazy matrix vector product of a matrix view with a vector view.
+ */
+template <typename A, typename X>
+GemvExpr<std::remove_const_t<A>> operator*(const MatrixView<A> &m, const VectorView<X> &x)
+{
+    using T = std::remove_const_t<A>;
+    return GemvExpr<T>(MatrixView<const T>(m), VectorView<const T>(x));
+}
+
+/**
+ * @brief Lazy matrix vector product of a matrix with a vector view.
+ */
+template <typename T, typename X>
+GemvExpr<T> operator*(const Matrix<T> &m, const VectorView<X> &x)
+{
+    return GemvExpr<T>(m.view(), VectorView<const T>(x));
+}
+
+/**
+ * @brief Lazily applies a unary function to every element of an operand.
+ *
+ * @param e A vector, a view or an expression.
+ * @param fn The function to apply, e.g. std::cref(activation).
+ */
+template <typename E, typename F, typename = std::enable_if_t<detail::is_operand_v<E>>>
+auto map(const E &e, F fn)
+{
+    return MapExpr<detail::expr_t<E>, F>(detail::as_expr(e), fn);
+}
+
+/**
+ * @brief Evaluates an expression element by element with op(out[i], e[i]).
+ *        \n Large expressions are split over the thread pool when PARALLEL is enabled.
+ */
+template <typename T, typename E, typename Op>
+void evaluate(VectorView<T> out, const VecExpr<E> &expr, Op op)
+{
+    const E &e = expr.self();
+
+    if (out.size() != e.size())
+    {
+        throw std::invalid_argument("The number of vector rows must be equal in expression assignment. ");
+    }
+
+    auto body = [&](std::size_t first, std::size_t last)
+    {
+        for (int i = static_cast<int>(first); i < static_cast<int>(last); i++)
+        {
+            op(out[i], e[i]);
+        }
+    };
+
+    /*same work thresholds as the parallel.h kernels: about 64k operations per call*/
+    std::size_t n = out.size();
+    std::size_t cost = e.cost();
+    if (enable_parallel && n * cost >= (1 << 16))
+        parallel_for(0, n, std::max<std::size_t>((1 << 14) / cost, 4), body);
+    else
+        body(0, n);
+}
+
+/**
+ * @brief Evaluates an expression into a view, out = e.
+ * @note out must not alias the vector operand of a matrix vector product in e.
+ * @throws std::invalid_argument if the sizes differ.
+ */
+template <typename T, typename E>
+void assign(VectorView<T> out, const VecExpr<E> &e)
+{
+    evaluate(out, e, [](T &o, const T &v) { o = v; });
+}
+
+/**
+ * @brief Accumulates an expression into a view, out += e (e.g. an axpy update out += a * x).
+ * @note out must not alias the vector operand of a matrix vector product in e.
+ * @throws std::invalid_argument if the sizes differ.
+ */
+template <typename T, typename E>
+void add_assign(VectorView<T> out, const VecExpr<E> &e)
+{
+    evaluate(out, e, [](T &o, const T &v) { o += v; });
+}
+
+}
+
+#endif // EXPRESSION_H
@@ -0,0 +1,219 @@
+/**
+ * @file parameters.hpp
+ * @brief This file contains the declaration of the ParameterBuffer class.
+ */
+
+#ifndef PARAMETERS_H
+#define PARAMETERS_H
+
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Matrix.hpp"
+#include "Vector.hpp"
+
+namespace phoenix {
+
+/**
+ *  @brief One aligned allocation holding every weight and bias of a dense network.
+ *         \n The layout is [W0, W1, ..., Wn, B0, B1, ..., Bn] with each W row-major, the
+ *         \n order in which a model is saved, so a checkpoint is a single write and an
+ *         \n update of all parameters is a single linear sweep. weight() and bias() return
+ *         \n matrices that alias the buffer and keep it alive, they are not copies.
+ *
+ *  @tparam T Type of the parameters.
+ */
+template <typename T>
+class ParameterBuffer
+{
+private:
+    std::shared_ptr<T[]> storage;
+    std::vector<int> dims;
+    std::vector<std::size_t> weight_offset;
+    std::vector<std::size_t> bias_offset;
+    std::size_t weight_count = 0;
+    std::size_t total = 0;
+
+    void check(int l) const
+    {
+        if (l < 0 || l >= layers())
+        {
+            throw std::invalid_argument("Accessing wrong layer of parameter buffer. ");
+        }
+    }
+
+public:
+    /**
+     * @brief Constructs an empty parameter buffer.
+     */
+    ParameterBuffer() {}
+
+    /**
+     * @brief Allocates the parameters of a dense network, zero filled.
+     *
+     * @param sizes Number of neurons per layer: input, hidden..., output.
+     * @throws std::invalid_argument if fewer than two sizes are given.
+     */
+    explicit ParameterBuffer(const std::vector<int> &sizes) : dims(sizes)
+    {
+        if (dims.size() < 2)
+        {
+            throw std::invalid_argument("A parameter buffer needs at least an input and an output size. ");
+        }
+
+        for (std::size_t l = 0; l + 1 < dims.size(); l++)
+        {
+            weight_offset.push_back(total);
+            total += static_cast<std::size_t>(dims[l + 1]) * dims[l];
+        }
+        weight_count = total;
+
+        for (std::size_t l = 0; l + 1 < dims.size(); l++)
+        {
+            bias_offset.push_back(total);
+            total += dims[l + 1];
+        }
+
+        storage = allocate_storage<T>(total);
+    }
+
+    /**
+     * @brief Number of neurons per layer the buffer was built for, e.g. to allocate a gradient of the same layout.
+     */
+    const std::vector<int> &shape() const { return dims; }
+
+    /**
+     * @brief Number of weight layers.
+     */
+    int layers() const { return static_cast<int>(weight_offset.size()); }
+
+    /**
+     * @brief Returns the weight matrix of layer l (outputs x inputs), sharing the buffer.
+     * @throws std::invalid_argument if l is out of range.
+     */
+    Matrix<T> weight(int l) const
+    {
+        check(l);
+        return Matrix<T>(storage, storage.get() + weight_offset[l], dims[l + 1], dims[l]);
+    }
+
+    /**
+     * @brief Returns the bias vector of layer l, sharing the buffer.
+     * @throws std::invalid_argument if l is out of range.
+     */
+    Vector<T> bias(int l) const
+    {
+        check(l);
+        return Vector<T>(storage, storage.get() + bias_offset[l], dims[l + 1]);
+    }
+
+    /**
+     * @brief Pointer to the first parameter, 64-byte aligned.
+     */
+    T *data() { return storage.get(); }
+    const T *data() const { return storage.get(); }
+
+    /**
+     * @brief Total number of parameters.
+     */
+    std::size_t size() const { return total; }
+
+    /**
+     * @brief Returns a view on every parameter, weights first.
+     */
+    VectorView<T> view() { return VectorView<T>(storage.get(), static_cast<int>(total)); }
+
+    /**
+     * @brief Returns a view on all weights of the network.
+     */
+    VectorView<T> weights() { return VectorView<T>(storage.get(), static_cast<int>(weight_count)); }
+
+    /**
+     * @brief Returns a view on all biases of the network.
+     */
+    VectorView<T> biases() { return VectorView<T>(storage.get() + weight_count, static_cast<int>(total - weight_count)); }
+};
+
+/*tag at the start of a model file, the last character is the size of a saved parameter*/
+template <typename T>
+constexpr char parameter_magic[4] = {'P', 'H', 'P', static_cast<char>('0' + sizeof(T))};
+
+/**
+ * @brief Writes the tag that records the precision of the parameters saved after it.
+ *
+ * @param file The model file, at its start.
+ * @tparam T Type of the saved parameters.
+ */
+template <typename T>
+void write_precision(std::ostream &file)
+{
+    file.write(parameter_magic<T>, sizeof(parameter_magic<T>));
+}
+
+/**
+ * @brief Reads the precision tag of a model file.
+ *        \n Files saved before the tag existed start with the layer sizes and hold doubles,
+ *        \n for them the stream is rewound to the start.
+ *
+ * @param file The model file, at its start.
+ * @return The size in bytes of a saved parameter, 0 if the file has an unknown tag.
+ */
+inline std::size_t read_precision(std::istream &file)
+{
+    char magic[sizeof(parameter_magic<double>)] = {};
+    std::streampos start = file.tellg();
+    file.read(magic, sizeof(magic));
+
+    if (file && std::memcmp(magic, parameter_magic<float>, sizeof(magic)) == 0)
+        return sizeof(float);
+    if (file && std::memcmp(magic, parameter_magic<double>, sizeof(magic)) == 0)
+        return sizeof(double);
+    if (file && magic[0] == 'P' && magic[1] == 'H')
+        return 0;
+
+    file.clear();
+    file.seekg(start);
+    return sizeof(double);
+}
+
+/**
+ * @brief Number of bytes between the read position of a file and its end.
+ */
+inline std::size_t remaining_bytes(std::istream &file)
+{
+    std::streampos here = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streampos end = file.tellg();
+    file.seekg(here);
+    return (here < 0 || end < here) ? 0 : static_cast<std::size_t>(end - here);
+}
+
+/**
+ * @brief Checks that a model file holds parameters of type T, reporting on std::cerr if not.
+ *
+ * @param file The model file, at its start. On success it is left after the tag.
+ * @param filename The name of the file, for the message.
+ * @return true if the saved parameters are of type T.
+ */
+template <typename T>
+bool check_precision(std::istream &file, const std::string &filename)
+{
+    std::size_t saved = read_precision(file);
+    if (saved == sizeof(T))
+        return true;
+
+    if (saved == 0)
+        std::cerr << "Error: " << filename << " is not a model file\n";
+    else
+        std::cerr << "Error: " << filename << " holds " << (saved == sizeof(float) ? "float" : "double")
+                  << " parameters, load it into a model of that precision\n";
+    return false;
+}
+
+}
+
+#endif // PARAMETERS_H
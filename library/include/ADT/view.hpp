@@ -0,0 +1,235 @@
+/**
+ * @file view.hpp
+ * @brief This file contains the declaration of the non-owning MatrixView and VectorView classes.
+ */
+
+#ifndef VIEW_H
+#define VIEW_H
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace phoenix {
+
+/**
+ *  @brief A non-owning, strided window on a vector of values.
+ *         \n Element i lives at data()[i * stride()]. A view never allocates or copies,
+ *         \n it only stays valid while the storage it points into is alive.
+ *
+ *  @tparam T Type of elements, const qualified for a read-only view.
+ */
+template <typename T>
+class VectorView
+{
+private:
+    T *ptr;
+    int n;
+    std::ptrdiff_t inc;
+
+public:
+    /**
+     * @brief Constructs a view on n elements starting at data, stride elements apart.
+     */
+    VectorView(T *data, int size, std::ptrdiff_t stride = 1) : ptr(data), n(size), inc(stride) {}
+
+    /**
+     * @brief A view on mutable elements converts to a read-only view.
+     */
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+    VectorView(const VectorView<U> &other) : ptr(other.data()), n(other.size()), inc(other.stride()) {}
+
+    /**
+     * @brief Accesses element at index i (unchecked).
+     */
+    T &operator[](int i) const { return ptr[i * inc]; }
+
+    /**
+     * @brief Number of elements in the view.
+     */
+    int size() const { return n; }
+
+    /**
+     * @brief Number of rows, a vector view is a column.
+     */
+    int getRows() const { return n; }
+
+    /**
+     * @brief Distance in elements between two consecutive elements.
+     */
+    std::ptrdiff_t stride() const { return inc; }
+
+    /**
+     * @brief Pointer to the first element.
+     */
+    T *data() const { return ptr; }
+
+    /**
+     * @brief True if the elements are adjacent in memory.
+     */
+    bool contiguous() const { return inc == 1 || n <= 1; }
+
+    /**
+     * @brief Returns the view on count elements starting at index start.
+     * @throws std::invalid_argument if the range is outside the view.
+     */
+    VectorView<T> segment(int start, int count) const
+    {
+        if (start < 0 || count < 0 || start + count > n)
+        {
+            throw std::invalid_argument("Accessing wrong segment of vector view. ");
+        }
+        return VectorView<T>(ptr + start * inc, count, inc);
+    }
+};
+
+/**
+ *  @brief A non-owning, strided window on a 2D block of values.
+ *         \n Element (i, j) lives at data()[i * rowStride() + j * colStride()], so rows,
+ *         \n columns, sub-blocks and transposes of a matrix are all views on the same buffer.
+ *
+ *  @tparam T Type of elements, const qualified for a read-only view.
+ */
+template <typename T>
+class MatrixView
+{
+private:
+    T *ptr;
+    int rows;
+    int cols;
+    std::ptrdiff_t rs;
+    std::ptrdiff_t cs;
+
+public:
+    /**
+     * @brief Constructs a view on a r x c block starting at data.
+     * @param data Pointer to element (0, 0).
+     * @param r Number of rows.
+     * @param c Number of columns.
+     * @param row_stride Distance in elements between two rows.
+     * @param col_stride Distance in elements between two columns.
+     */
+    MatrixView(T *data, int r, int c, std::ptrdiff_t row_stride, std::ptrdiff_t col_stride = 1)
+        : ptr(data), rows(r), cols(c), rs(row_stride), cs(col_stride) {}
+
+    /**
+     * @brief A view on mutable elements converts to a read-only view.
+     */
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+    MatrixView(const MatrixView<U> &other)
+        : ptr(other.data()), rows(other.getRows()), cols(other.getCols()),
+          rs(other.rowStride()), cs(other.colStride()) {}
+
+    /**
+     * @brief Accesses element (i, j) (unchecked).
+     */
+    T &operator()(int i, int j) const { return ptr[i * rs + j * cs]; }
+
+    /**
+     * @brief Get the number of rows in the view.
+     */
+    int getRows() const { return rows; }
+
+    /**
+     * @brief Get the number of cols in the view.
+     */
+    int getCols() const { return cols; }
+
+    /**
+     * @brief Get the total number of elements in the view.
+     */
+    int size() const { return rows * cols; }
+
+    /**
+     * @brief Distance in elements between two consecutive rows.
+     */
+    std::ptrdiff_t rowStride() const { return rs; }
+
+    /**
+     * @brief Distance in elements between two consecutive columns.
+     */
+    std::ptrdiff_t colStride() const { return cs; }
+
+    /**
+     * @brief Pointer to element (0, 0).
+     */
+    T *data() const { return ptr; }
+
+    /**
+     * @brief True if every row is a contiguous run of elements.
+     */
+    bool contiguousRows() const { return cs == 1 || cols <= 1; }
+
+    /**
+     * @brief Returns the view on row i.
+     * @throws std::invalid_argument if i is out of range.
+     */
+    VectorView<T> row(int i) const
+    {
+        if (i < 0 || i >= rows)
+        {
+            throw std::invalid_argument("Accessing wrong row of matrix view. ");
+        }
+        return VectorView<T>(ptr + i * rs, cols, cs);
+    }
+
+    /**
+     * @brief Returns the view on column j.
+     * @throws std::invalid_argument if j is out of range.
+     */
+    VectorView<T> col(int j) const
+    {
+        if (j < 0 || j >= cols)
+        {
+            throw std::invalid_argument("Accessing wrong column of matrix view. ");
+        }
+        return VectorView<T>(ptr + j * cs, rows, rs);
+    }
+
+    /**
+     * @brief Returns the view on the nr x nc block whose top left element is (r, c).
+     * @throws std::invalid_argument if the block is outside the view.
+     */
+    MatrixView<T> block(int r, int c, int nr, int nc) const
+    {
+        if (r < 0 || c < 0 || nr < 0 || nc < 0 || r + nr > rows || c + nc > cols)
+        {
+            throw std::invalid_argument("Accessing wrong block of matrix view. ");
+        }
+        return MatrixView<T>(ptr + r * rs + c * cs, nr, nc, rs, cs);
+    }
+
+    /**
+     * @brief Returns the transposed view, no element is moved.
+     */
+    MatrixView<T> transpose() const { return MatrixView<T>(ptr, cols, rows, cs, rs); }
+};
+
+/**
+ * @brief Copies the elements of one vector view into another of the same size.
+ * @throws std::invalid_argument if the sizes differ.
+ */
+template <typename S, typename T>
+void copy(VectorView<S> src, VectorView<T> dst)
+{
+    if (src.size() != dst.size())
+    {
+        throw std::invalid_argument("The size of vector views must be equal in copy. ");
+    }
+
+    if (src.contiguous() && dst.contiguous())
+    {
+        std::copy(src.data(), src.data() + src.size(), dst.data());
+        return;
+    }
+
+    for (int i = 0; i < src.size(); i++)
+    {
+        dst[i] = src[i];
+    }
+}
+
+}
+
+#endif // VIEW_H
@@ -1,5 +1,10 @@
+#ifndef ACTIVATIONS_H
+#define ACTIVATIONS_H
+
 #include <iostream>
 #include <cmath>
+#include <string>
+#include "simd.h"
 
 double sigmoid(double x);
  
@@ -13,3 +18,79 @@ double linear(double x);
  
 double linear_derivative(double a);
 
+float sigmoid(float x);
+
+float sigmoid_derivative(float a);
+
+float relu(float x);
+
+float relu_derivative(float a);
+
+float linear(float x);
+
+float linear_derivative(float a);
+
+/**
+ * @brief Activation functions that NeuralModel::NNConnfigure resolves by name.
+ */
+enum class Activation : int
+{
+    sigmoid = 0,
+    relu = 1,
+    linear = 2,
+    tanh = 3,
+    leaky_relu = 4,
+    gelu = 5,
+    softmax = 6
+};
+
+/**
+ * @brief Whole-span kernels of one activation function.
+ *        \n activate writes y = f(z) and gradient writes out = e * f'(z) over n contiguous
+ *        \n elements; out may alias e. The function is inlined into the loop, there is
+ *        \n no indirect call per element.
+ *        \n gradient gets both the pre-activation z and the output y = f(z) cached by the
+ *        \n forward pass and uses whichever is cheaper, e.g. y * (1 - y) for the sigmoid,
+ *        \n so only GELU evaluates a transcendental function in the backward pass.
+ *        \n softmax normalizes the whole span as one distribution and is meant for the output
+ *        \n layer with the cross-entropy loss; its gradient passes e through unchanged because
+ *        \n the error handed to it, expected - p, already is the gradient of the fused pair.
+ *
+ * @tparam T float or double.
+ */
+template <typename T>
+struct ActivationKernels
+{
+    Activation kind;
+    const char *name;
+    void (*activate)(int n, const T *z, T *y);
+    void (*gradient)(int n, const T *z, const T *y, const T *e, T *out);
+};
+
+/**
+ * @brief Sets how exactly the sigmoid, tanh and softmax kernels evaluate the exponential.
+ *        \n The default is exact, or the PHOENIX_ACCURACY environment variable (exact, high
+ *        \n or fast). fast (relative error near 1e-3) is meant for inference on small devices.
+ */
+void set_activation_accuracy(phoenix::simd::accuracy acc);
+
+/**
+ * @brief Returns the accuracy used by the sigmoid, tanh and softmax kernels.
+ */
+phoenix::simd::accuracy activation_accuracy();
+
+/**
+ * @brief Returns the kernels of an activation function.
+ */
+template <typename T>
+const ActivationKernels<T> &activation_kernels(Activation kind);
+
+/**
+ * @brief Returns the kernels of an activation function by name:
+ *        \n "sigmoid", "relu", "linear", "tanh", "leaky_relu", "gelu" or "softmax".
+ * @throws std::invalid_argument if the name is unknown.
+ */
+template <typename T>
+const ActivationKernels<T> &activation_kernels(const std::string &name);
+
+#endif
@@ -0,0 +1,298 @@
+/**
+ * @file gemm.h
+ * @brief Cache-blocked general matrix-matrix multiply used by Matrix<T>::operator*.
+ *
+ *  \n The product is computed the classic way: C is walked in NC wide column panels,
+ *  \n the shared dimension in KC deep slices and A in MC tall row blocks. Each slice of
+ *  \n B (KC x NC) and block of A (MC x KC) is packed into contiguous, zero padded slivers
+ *  \n so that the MR x NR register tile of the micro-kernel streams both operands with
+ *  \n unit stride out of L1/L2 cache.
+ *  \n Operands are addressed through a row stride and a column stride, so transposed or
+ *  \n strided inputs are handled by the packing routines with no extra copy.
+ *  \n With PARALLEL enabled the MC blocks of a large product are spread over the thread pool.
+ */
+
+#ifndef GEMM_H
+#define GEMM_H
+
+#include <config.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#include "simd.h"
+#include "threadpool.h"
+
+namespace phoenix {
+
+/**
+ * @brief Blocking parameters of the GEMM engine for a given element type.
+ *
+ * @tparam T Type of the matrix elements.
+ * @note MR x NR is the register tile, MC/KC/NC are the L2/L1/L3 blocking sizes.
+ */
+template <typename T>
+struct gemm_blocking
+{
+    static constexpr int MR = 4;
+    static constexpr int NR = 4;
+    static constexpr int MC = 64;
+    static constexpr int KC = 128;
+    static constexpr int NC = 1024;
+};
+
+template <>
+struct gemm_blocking<double>
+{
+    static constexpr int MR = simd::tile_shape<double>::rows;
+    static constexpr int NR = simd::tile_shape<double>::cols;
+    static constexpr int MC = 96;
+    static constexpr int KC = 256;
+    static constexpr int NC = 4096;
+};
+
+template <>
+struct gemm_blocking<float>
+{
+    static constexpr int MR = simd::tile_shape<float>::rows;
+    static constexpr int NR = simd::tile_shape<float>::cols;
+    static constexpr int MC = 128;
+    static constexpr int KC = 384;
+    static constexpr int NC = 4096;
+};
+
+/**
+ * @brief Minimum number of multiply-adds in one KC slice before its MC blocks run in parallel.
+ */
+constexpr double gemm_parallel_threshold = 1 << 20;
+
+/**
+ * @brief Returns a per thread scratch buffer of at least n elements for the packed operands.
+ *
+ * @tparam T Type of the matrix elements.
+ * @tparam Slot Distinguishes the A and B buffers of one thread.
+ */
+template <typename T, int Slot>
+T *gemm_buffer(std::size_t n)
+{
+    thread_local std::vector<T> buffer;
+    if (buffer.size() < n)
+        buffer.resize(n);
+    return buffer.data();
+}
+
+/**
+ * @brief Packs an mc x kc block of A into MR tall slivers, scaling by alpha.
+ *
+ * @param mc Number of rows in the block.
+ * @param kc Number of columns in the block.
+ * @param a Pointer to the first element of the block.
+ * @param rsa Row stride of A.
+ * @param csa Column stride of A.
+ * @param alpha Scalar applied to every packed element.
+ * @param packed Destination buffer of at least ceil(mc / MR) * MR * kc elements.
+ */
+template <typename T>
+void gemm_pack_a(int mc, int kc, const T *a, std::ptrdiff_t rsa, std::ptrdiff_t csa, T alpha, T *packed)
+{
+    constexpr int MR = gemm_blocking<T>::MR;
+
+    for (int i = 0; i < mc; i += MR)
+    {
+        int mr = std::min(MR, mc - i);
+        for (int p = 0; p < kc; p++)
+        {
+            int r = 0;
+            for (; r < mr; r++)
+                *packed++ = alpha * a[(i + r) * rsa + p * csa];
+            for (; r < MR; r++)
+                *packed++ = T(0);
+        }
+    }
+}
+
+/**
+ * @brief Packs a kc x nc slice of B into NR wide slivers.
+ *
+ * @param kc Number of rows in the slice.
+ * @param nc Number of columns in the slice.
+ * @param b Pointer to the first element of the slice.
+ * @param rsb Row stride of B.
+ * @param csb Column stride of B.
+ * @param packed Destination buffer of at least ceil(nc / NR) * NR * kc elements.
+ */
+template <typename T>
+void gemm_pack_b(int kc, int nc, const T *b, std::ptrdiff_t rsb, std::ptrdiff_t csb, T *packed)
+{
+    constexpr int NR = gemm_blocking<T>::NR;
+
+    for (int j = 0; j < nc; j += NR)
+    {
+        int nr = std::min(NR, nc - j);
+        for (int p = 0; p < kc; p++)
+        {
+            int c = 0;
+            for (; c < nr; c++)
+                *packed++ = b[p * rsb + (j + c) * csb];
+            for (; c < NR; c++)
+                *packed++ = T(0);
+        }
+    }
+}
+
+/**
+ * @brief Register tiled micro-kernel, C[mr x nr] += A_sliver * B_sliver.
+ *
+ *  \n The MR x NR accumulator tile lives in registers for the whole kc loop and C
+ *  \n is touched exactly once, at the end. float and double use simd::gemm_tile.
+ *
+ * @param kc Depth of the packed slivers.
+ * @param a Packed A sliver (kc groups of MR elements).
+ * @param b Packed B sliver (kc groups of NR elements).
+ * @param c Pointer to the top left element of the C tile.
+ * @param rsc Row stride of C.
+ * @param csc Column stride of C.
+ * @param mr Number of valid rows in the tile (<= MR).
+ * @param nr Number of valid columns in the tile (<= NR).
+ */
+template <typename T>
+inline void gemm_micro_kernel(int kc, const T *a, const T *b, T *c,
+                              std::ptrdiff_t rsc, std::ptrdiff_t csc, int mr, int nr)
+{
+    /*float and double tiles run on the runtime dispatched vector kernel*/
+    if constexpr (std::is_same_v<T, double> || std::is_same_v<T, float>)
+    {
+        simd::gemm_tile(kc, a, b, c, rsc, csc, mr, nr);
+    }
+    else
+    {
+        constexpr int MR = gemm_blocking<T>::MR;
+        constexpr int NR = gemm_blocking<T>::NR;
+
+        T acc[MR][NR] = {};
+
+        for (int p = 0; p < kc; p++)
+        {
+            const T *ap = a + p * MR;
+            const T *bp = b + p * NR;
+            for (int i = 0; i < MR; i++)
+            {
+                for (int j = 0; j < NR; j++)
+                {
+                    acc[i][j] += ap[i] * bp[j];
+                }
+            }
+        }
+
+        for (int i = 0; i < mr; i++)
+        {
+            for (int j = 0; j < nr; j++)
+            {
+                c[i * rsc + j * csc] += acc[i][j];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Computes C = alpha * A * B + beta * C for strided operands.
+ *
+ * @param m Number of rows of A and C.
+ * @param n Number of columns of B and C.
+ * @param k Number of columns of A and rows of B.
+ * @param alpha Scalar applied to the product.
+ * @param a Pointer to A, element (i, p) is a[i * rsa + p * csa].
+ * @param rsa Row stride of A.
+ * @param csa Column stride of A.
+ * @param b Pointer to B, element (p, j) is b[p * rsb + j * csb].
+ * @param rsb Row stride of B.
+ * @param csb Column stride of B.
+ * @param beta Scalar applied to C before accumulation, C is not read when beta is 0
+ *             \n and not rewritten when beta is 1.
+ * @param c Pointer to C, element (i, j) is c[i * rsc + j * csc].
+ * @param rsc Row stride of C.
+ * @param csc Column stride of C.
+ * @tparam T The type of the elements in the matrices.
+ */
+template <typename T>
+void gemm(int m, int n, int k, T alpha,
+          const T *a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+          const T *b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+          T beta, T *c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+{
+    constexpr int MR = gemm_blocking<T>::MR;
+    constexpr int NR = gemm_blocking<T>::NR;
+    constexpr int MC = gemm_blocking<T>::MC;
+    constexpr int KC = gemm_blocking<T>::KC;
+    constexpr int NC = gemm_blocking<T>::NC;
+
+    if (m <= 0 || n <= 0)
+        return;
+
+    /*scale C by beta up front so the kernel only ever accumulates*/
+    if (beta != T(1))
+    {
+        for (int i = 0; i < m; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                T &cij = c[i * rsc + j * csc];
+                cij = (beta == T(0)) ? T(0) : beta * cij;
+            }
+        }
+    }
+
+    if (k <= 0 || alpha == T(0))
+        return;
+
+    /*packing buffers are kept per thread and reused across calls*/
+    T *b_pack = gemm_buffer<T, 1>(static_cast<std::size_t>(KC) * (NC + NR));
+    int m_blocks = (m + MC - 1) / MC;
+
+    for (int jc = 0; jc < n; jc += NC)
+    {
+        int nc = std::min(NC, n - jc);
+
+        for (int pc = 0; pc < k; pc += KC)
+        {
+            int kc = std::min(KC, k - pc);
+            gemm_pack_b(kc, nc, b + pc * rsb + jc * csb, rsb, csb, b_pack);
+
+            auto row_blocks = [&](std::size_t first, std::size_t last)
+            {
+                T *a_pack = gemm_buffer<T, 0>(static_cast<std::size_t>(MC) * KC);
+
+                for (std::size_t block = first; block < last; block++)
+                {
+                    int ic = static_cast<int>(block) * MC;
+                    int mc = std::min(MC, m - ic);
+                    gemm_pack_a(mc, kc, a + ic * rsa + pc * csa, rsa, csa, alpha, a_pack);
+
+                    for (int jr = 0; jr < nc; jr += NR)
+                    {
+                        int nr = std::min(NR, nc - jr);
+                        const T *bp = b_pack + static_cast<std::size_t>(jr) * kc;
+
+                        for (int ir = 0; ir < mc; ir += MR)
+                        {
+                            int mr = std::min(MR, mc - ir);
+                            const T *ap = a_pack + static_cast<std::size_t>(ir) * kc;
+                            T *cp = c + (ic + ir) * rsc + (jc + jr) * csc;
+
+                            gemm_micro_kernel(kc, ap, bp, cp, rsc, csc, mr, nr);
+                        }
+                    }
+                }
+            };
+
+            if (enable_parallel && m_blocks > 1 && static_cast<double>(m) * nc * kc >= gemm_parallel_threshold)
+                parallel_for(0, m_blocks, 1, row_blocks);
+            else
+                row_blocks(0, m_blocks);
+        }
+    }
+}
+
+}
+
+#endif // GEMM_H
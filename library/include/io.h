@@ -10,8 +10,10 @@ using namespace phoenix;
     @brief Reads a file and converts its contents to a Matrix object.
     @param filename The name of the file to read.
     @param delimeter The character used to separate values in the file.
-    @return Matrix<double> The matrix object containing the values read from the file.
+    @return Matrix<T> The matrix object containing the values read from the file.
     @note If the file cannot be opened or there is an error in the file conversion, 
             \n an empty matrix object is returned.
+    @tparam T Type of the matrix elements, instantiated for float and double.
 **/
-Matrix<double> ReadFileToMatrix(const std::string& filename, char delimeter);
\ No newline at end of file
+template <typename T = double>
+Matrix<T> ReadFileToMatrix(const std::string& filename, char delimeter);
\ No newline at end of file
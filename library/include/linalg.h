@@ -0,0 +1,107 @@
+/**
+ * @file linalg.h
+ * @brief Direct least squares solvers used to fit linear models in closed form.
+ */
+
+#ifndef LINALG_H
+#define LINALG_H
+
+#include <config.hpp>
+#include "Matrix.hpp"
+
+using namespace phoenix;
+
+/**
+ * @brief How a linear least squares problem is solved.
+ *        \n cholesky forms the normal equations X^T X w = X^T y and factors them, one cheap
+ *        \n pass over the data that squares the condition number of X. qr reduces X itself
+ *        \n to a triangular factor with Givens rotations, about twice the work but accurate
+ *        \n for ill-conditioned or nearly collinear features.
+ */
+enum class LinearSolver
+{
+    cholesky = 0,
+    qr = 1
+};
+
+/**
+ * @brief How a logistic regression is trained.
+ *        \n newton is iteratively reweighted least squares, every iteration builds and factors
+ *        \n the (cols + 1) x (cols + 1) Hessian, converging in a handful of passes for modest
+ *        \n feature counts. lbfgs only evaluates the loss and gradient and approximates the
+ *        \n curvature from the last lbfgs_memory steps, for wide data.
+ */
+enum class LogisticSolver
+{
+    newton = 0,
+    lbfgs = 1
+};
+
+/*number of step and gradient differences L-BFGS keeps*/
+constexpr int lbfgs_memory = 10;
+
+/*rows of the data staged and accumulated at once by the direct solvers*/
+constexpr int least_squares_block_rows = 256;
+
+/*below this many multiply-adds the data is reduced on the calling thread*/
+constexpr double least_squares_parallel_threshold = 1 << 20;
+
+/**
+ * @brief Accumulates the normal equations of X augmented by a column of ones.
+ *        \n The rows are staged in blocks of least_squares_block_rows and multiplied by the
+ *        \n blocked gemm kernel, the blocks are spread over the thread pool when PARALLEL is
+ *        \n enabled and summed in a fixed order, so the result does not depend on the thread count.
+ *
+ * @param X Data, one sample per row.
+ * @param Y Targets, one sample per row.
+ * @param xtx Receives [X 1]^T [X 1], (cols + 1) x (cols + 1), the intercept last.
+ * @param xty Receives [X 1]^T Y, (cols + 1) x Y.cols.
+ * @throws std::invalid_argument if X and Y differ in rows or the outputs have the wrong shape.
+ */
+template <typename T>
+void normal_equations(MatrixView<const T> X, MatrixView<const T> Y, Matrix<double> &xtx, Matrix<double> &xty);
+
+/**
+ * @brief Solves A x = B in place for a symmetric positive definite A.
+ *
+ * @param a The p x p matrix A, overwritten by its Cholesky factor.
+ * @param b The p x m right hand sides, overwritten by the solution.
+ * @throws std::invalid_argument if A is not (numerically) positive definite.
+ */
+void cholesky_solve(Matrix<double> &a, Matrix<double> &b);
+
+/**
+ * @brief Returns the least squares solution of [X 1] w = Y with an optional ridge penalty.
+ *        \n ridge * ||w||^2 is added to the squared error, the intercept is not penalised.
+ *
+ * @param X Data, one sample per row.
+ * @param Y Targets, one sample per row.
+ * @param solver Normal equations with Cholesky or Givens QR on the data.
+ * @param ridge Non-negative weight of the penalty, 0 for ordinary least squares.
+ * @return (cols + 1) x Y.cols coefficients, row j holds the weights of feature j, the last row the intercepts.
+ * @throws std::invalid_argument if the shapes do not match, ridge is negative or the problem is singular.
+ */
+template <typename T>
+Matrix<double> least_squares(MatrixView<const T> X, MatrixView<const T> Y, LinearSolver solver, double ridge = 0);
+
+/**
+ * @brief Fits an independent logistic regression for every column of Y.
+ *        \n Minimizes the summed cross-entropy of sigmoid([X 1] w) against the targets plus
+ *        \n ridge / 2 * ||w||^2 (the intercept is not penalised), with full passes over the data.
+ *        \n Iterations stop once the largest gradient entry of the mean loss is below
+ *        \n tolerance, or when a line search makes no more progress.
+ *
+ * @param X Data, one sample per row.
+ * @param Y Targets in [0, 1], one sample per row.
+ * @param solver Newton (IRLS) or L-BFGS.
+ * @param ridge Non-negative weight of the penalty.
+ * @param max_iterations Largest number of iterations per output.
+ * @param tolerance Convergence threshold on the gradient of the mean loss.
+ * @return (cols + 1) x Y.cols coefficients, row j holds the weights of feature j, the last row the intercepts.
+ * @throws std::invalid_argument if the shapes do not match, ridge is negative or a Hessian is singular.
+ */
+template <typename T>
+Matrix<double> logistic_regression(MatrixView<const T> X, MatrixView<const T> Y, LogisticSolver solver,
+                                   double ridge = 0, int max_iterations = 100, double tolerance = 1e-6);
+
+#endif // LINALG_H
@@ -7,10 +7,14 @@ using namespace phoenix;
 
 /**
  * @brief An interface for a neural network implementation.
+ * @tparam T Scalar type of the model (float or double).
  **/
+template <typename T = double>
 class INeuralNetwork
 {
 public:
+    virtual ~INeuralNetwork() = default;
+
     /**
      * @brief Trains the neural network for a specified number of epochs.
      * @param epochs The number of epochs to train the neural network for.
@@ -22,7 +26,7 @@ public:
      * @param predict The vector input to the neural network to be predicted.
      * @return Vector The output predicted by the neural network.
      */
-    virtual Vector<double> predict(const Vector<double> &predict) = 0;
+    virtual Vector<T> predict(const Vector<T> &predict) = 0;
 
     /**
      * @brief Saves the current state of the neural network to a file.
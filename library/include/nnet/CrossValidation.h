@@ -0,0 +1,163 @@
+/**
+ * @file CrossValidation.h
+ * @brief K-fold cross-validation of NeuralModel based models on row index folds.
+ */
+
+#ifndef CROSS_VALIDATION_H
+#define CROSS_VALIDATION_H
+
+#include <config.hpp>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "nn.h"
+#include "threadpool.h"
+
+using namespace phoenix;
+
+/**
+ * @brief Scores of the model trained on one fold.
+ */
+struct FoldMetrics
+{
+    double train_loss = 0; /**< Training error of the last epoch */
+    double test_loss = 0;  /**< Mean loss on the held out rows */
+    double accuracy = 0;   /**< Accuracy on the held out rows, meaningful for one-hot targets */
+};
+
+/**
+ * @brief Per-fold and aggregate scores of a cross-validation.
+ */
+struct CrossValidationResult
+{
+    std::vector<FoldMetrics> folds; /**< One entry per fold, in fold order */
+    double mean_loss = 0;           /**< Mean of the held out losses */
+    double std_loss = 0;            /**< Sample standard deviation of the held out losses */
+    double mean_accuracy = 0;       /**< Mean of the held out accuracies */
+    double std_accuracy = 0;        /**< Sample standard deviation of the held out accuracies */
+};
+
+/**
+ * @brief Splits rows 0 .. rows - 1 into k folds of consecutive indices whose sizes differ by at most one.
+ *        \n Shuffle the indices first (or the data) if the rows are ordered.
+ *
+ * @param rows Number of rows of the data.
+ * @param k Number of folds.
+ * @return The row indices of each fold.
+ * @throws std::invalid_argument if k is smaller than 2 or larger than rows.
+ */
+inline std::vector<std::vector<int>> kfold_indices(int rows, int k)
+{
+    if (k < 2 || k > rows)
+    {
+        throw std::invalid_argument("The number of folds must be between 2 and the number of rows. ");
+    }
+
+    std::vector<std::vector<int>> folds(k);
+    for (int f = 0; f < k; f++)
+    {
+        int first = static_cast<int>(static_cast<long>(f) * rows / k);
+        int last = static_cast<int>(static_cast<long>(f + 1) * rows / k);
+        for (int i = first; i < last; i++)
+            folds[f].push_back(i);
+    }
+    return folds;
+}
+
+/**
+ * @brief Cross-validates a model on the given folds.
+ *        \n Fold f is held out while a fresh model trains on the rows of all other folds. The
+ *        \n folds are lists of row indices into X and Y, no fold is copied out of the data.
+ *        \n The models are built on the calling thread and then trained concurrently, one
+ *        \n per thread of the pool when PARALLEL is enabled.
+ *
+ * @param factory Callable factory(X, Y) returning a configured, untrained model for the shape
+ *                \n of X and Y as a std::unique_ptr or std::shared_ptr to a NeuralModel<T>
+ *                \n subclass, e.g. a SimpleNeuralNetwork<T>. The matrices are shared, not copied.
+ * @param X The input matrix, one sample per row.
+ * @param Y The expected output matrix, one sample per row.
+ * @param folds Row indices of each fold, e.g. from kfold_indices.
+ * @param epochs Number of epochs each model is trained for.
+ * @return The scores of every fold and their mean and standard deviation.
+ * @throws std::invalid_argument if there are fewer than two folds or an index is outside the data.
+ */
+template <typename T, typename Factory>
+CrossValidationResult cross_validate(Factory factory, Matrix<T> &X, Matrix<T> &Y,
+                                     const std::vector<std::vector<int>> &folds, int epochs = 100)
+{
+    int k = static_cast<int>(folds.size());
+    if (k < 2 || X.getRows() != Y.getRows())
+    {
+        throw std::invalid_argument("Cross-validation needs at least two folds and one output row per input row. ");
+    }
+
+    /*models are built serially, the factory need not be thread-safe*/
+    std::vector<decltype(factory(X, Y))> models;
+    std::vector<std::vector<int>> training(k);
+    for (int f = 0; f < k; f++)
+    {
+        models.push_back(factory(X, Y));
+        for (int g = 0; g < k; g++)
+        {
+            if (g != f)
+                training[f].insert(training[f].end(), folds[g].begin(), folds[g].end());
+        }
+    }
+
+    CrossValidationResult result;
+    result.folds.resize(k);
+
+    auto body = [&](std::size_t first, std::size_t last)
+    {
+        for (std::size_t f = first; f < last; f++)
+        {
+            NeuralModel<T> &model = *models[f];
+            FoldMetrics &metrics = result.folds[f];
+
+            for (int e = 0; e < epochs; e++)
+                metrics.train_loss = model.train_subset(X, Y, training[f]);
+            metrics.test_loss = model.loss(X, Y, folds[f]);
+            metrics.accuracy = model.accuracy(X, Y, folds[f]);
+        }
+    };
+
+    if (enable_parallel)
+        parallel_for(0, k, 1, body);
+    else
+        body(0, k);
+
+    for (const FoldMetrics &m : result.folds)
+    {
+        result.mean_loss += m.test_loss / k;
+        result.mean_accuracy += m.accuracy / k;
+    }
+    for (const FoldMetrics &m : result.folds)
+    {
+        result.std_loss += (m.test_loss - result.mean_loss) * (m.test_loss - result.mean_loss) / (k - 1);
+        result.std_accuracy += (m.accuracy - result.mean_accuracy) * (m.accuracy - result.mean_accuracy) / (k - 1);
+    }
+    result.std_loss = std::sqrt(result.std_loss);
+    result.std_accuracy = std::sqrt(result.std_accuracy);
+
+    return result;
+}
+
+/**
+ * @brief Cross-validates a model on k folds of consecutive rows, see kfold_indices.
+ *
+ * @param factory Callable factory(X, Y) returning a configured, untrained model, see above.
+ * @param X The input matrix, one sample per row.
+ * @param Y The expected output matrix, one sample per row.
+ * @param k Number of folds.
+ * @param epochs Number of epochs each model is trained for.
+ * @return The scores of every fold and their mean and standard deviation.
+ * @throws std::invalid_argument if k is smaller than 2 or larger than the number of rows.
+ */
+template <typename T, typename Factory>
+CrossValidationResult cross_validate(Factory factory, Matrix<T> &X, Matrix<T> &Y, int k, int epochs = 100)
+{
+    return cross_validate(factory, X, Y, kfold_indices(X.getRows(), k), epochs);
+}
+
+#endif
@@ -8,18 +8,22 @@
 
 #include "nn.h"
 #include "nn_interface.h"
+#include "linalg.h"
 #include <fstream>
 
 using namespace phoenix;
 
 /**
  * @brief Linear Regression Application Interface .
+ *
+ * @tparam T Scalar type of the model (float or double).
  */
-class LinearRegression : public NeuralModel, public INeuralNetwork {
+template <typename T = double>
+class LinearRegression : public NeuralModel<T>, public INeuralNetwork<T> {
     private:
 
-        Matrix<double> input;
-        Matrix<double> output;
+        Matrix<T> input;
+        Matrix<T> output;
         std::vector<int> H;
 
         int num_inputs;
@@ -35,8 +39,8 @@ class LinearRegression : public NeuralModel, public INeuralNetwork {
          * @param rin The input matrix for the model.
          * @param rout The output matrix for the model.
          */
-        LinearRegression(Matrix<double> &rin,
-                         Matrix<double> &rout
+        LinearRegression(Matrix<T> &rin,
+                         Matrix<T> &rout
                         );
 
          /**
@@ -51,13 +55,27 @@ class LinearRegression : public NeuralModel, public INeuralNetwork {
          */
         void train(const int epochs = 100);
 
+        /**
+         * @brief Fits the model in closed form instead of running epochs of gradient descent.
+         *        \n One pass over the training data builds either the normal equations (cholesky)
+         *        \n or a QR factor of the data (qr), then the weights come out of a triangular solve.
+         *        \n The first layer gets the least squares weights, later layers become the identity.
+         *
+         * @param solver LinearSolver::cholesky for speed, LinearSolver::qr for ill-conditioned data.
+         * @param ridge Weight of the L2 penalty on the weights (not the bias), 0 for plain least squares.
+         * @return The mean training loss of the fitted model, on the same scale as the train() error.
+         * @throws std::invalid_argument if a layer is not linear, a later layer is not square,
+         *         \n ridge is negative or the problem is singular.
+         */
+        double fit(LinearSolver solver = LinearSolver::cholesky, double ridge = 0);
+
         /**
          * @brief Predicts the output for the given input vector.
          *
          * @param predict The input vector for prediction.
          * @return The predicted output vector.
          */
-        Vector<double> predict(const Vector<double> &predict);
+        Vector<T> predict(const Vector<T> &predict);
 
         /**
          * @brief Configures the activation functions for the model.
@@ -70,6 +88,7 @@ class LinearRegression : public NeuralModel, public INeuralNetwork {
          * @brief Saves the model to a file with the given filename.
          *
          * @param filename The name of the file to save the model.
+         * @note Weights and biases are written as T, a model is loaded back with the same T.
          */
         void save(std::string filename);
 
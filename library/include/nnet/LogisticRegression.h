@@ -8,18 +8,22 @@
 
 #include "nn.h"
 #include "nn_interface.h"
+#include "linalg.h"
 #include <fstream>
 
 using namespace phoenix;
 
 /**
  * @brief Logistic Regression Application Interface .
+ *
+ * @tparam T Scalar type of the model (float or double).
  */
-class LogisticRegression : public NeuralModel, public INeuralNetwork {
+template <typename T = double>
+class LogisticRegression : public NeuralModel<T>, public INeuralNetwork<T> {
     private:
 
-        Matrix<double> input;
-        Matrix<double> output;
+        Matrix<T> input;
+        Matrix<T> output;
         std::vector<int> H;
 
         int num_inputs;
@@ -35,8 +39,8 @@ class LogisticRegression : public NeuralModel, public INeuralNetwork {
          * @param rin The input matrix for the model.
          * @param rout The output matrix for the model.
          */
-        LogisticRegression(Matrix<double> &rin,
-                         Matrix<double> &rout
+        LogisticRegression(Matrix<T> &rin,
+                         Matrix<T> &rout
                         );
 
          /**
@@ -51,13 +55,30 @@ class LogisticRegression : public NeuralModel, public INeuralNetwork {
          */
         void train(const int epochs = 100);
 
+        /**
+         * @brief Fits the model with a second-order or quasi-Newton method instead of fixed epochs of SGD.
+         *        \n Every iteration is one full pass over the training data, and iterations stop when
+         *        \n the gradient vanishes. The first layer gets the fitted weights, the later layers
+         *        \n pass them through to the sigmoid output unchanged.
+         *
+         * @param solver LogisticSolver::newton (IRLS) for modest feature counts, LogisticSolver::lbfgs for wide data.
+         * @param ridge Weight of the L2 penalty on the weights (not the bias), keeps separable data finite.
+         * @param max_iterations Largest number of iterations.
+         * @param tolerance Convergence threshold on the largest gradient entry of the mean cross-entropy.
+         * @return The mean training loss of the fitted model, on the same scale as the train() error.
+         * @throws std::invalid_argument if the layers are not linear with a sigmoid output, a later
+         *         \n layer is not square, ridge is negative or a Hessian is singular.
+         */
+        double fit(LogisticSolver solver = LogisticSolver::newton, double ridge = 0,
+                   int max_iterations = 100, double tolerance = 1e-6);
+
         /**
          * @brief Predicts the output for the given input vector.
          *
          * @param predict The input vector for prediction.
          * @return The predicted output vector.
          */
-        Vector<double> predict(const Vector<double> &predict);
+        Vector<T> predict(const Vector<T> &predict);
 
         /**
          * @brief Configures the activation functions for the model.
@@ -70,6 +91,7 @@ class LogisticRegression : public NeuralModel, public INeuralNetwork {
          * @brief Saves the model to a file with the given filename.
          *
          * @param filename The name of the file to save the model.
+         * @note Weights and biases are written as T, a model is loaded back with the same T.
          */
         void save(std::string filename);
 
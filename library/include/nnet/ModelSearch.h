@@ -0,0 +1,127 @@
+/**
+ * @file ModelSearch.h
+ * @brief Hyperparameter sweep over SimpleNeuralNetwork configurations with successive halving.
+ */
+
+#ifndef MODEL_SEARCH_H
+#define MODEL_SEARCH_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "simplenn.h"
+
+using namespace phoenix;
+
+/**
+ * @brief One candidate of a hyperparameter sweep.
+ */
+struct SearchConfig
+{
+    std::vector<int> hidden;              /**< Number of neurons in each hidden layer */
+    std::vector<std::string> activations; /**< One activation per hidden layer, then the output layer */
+    double learning_rate = 0.01;          /**< Learning rate of the model */
+    int batch_size = 1;                   /**< Samples per training step, see NeuralModel::setBatchSize */
+};
+
+/**
+ * @brief Trains many SimpleNeuralNetwork configurations concurrently and keeps the best one.
+ *        \n All models read the same training and validation matrices, the data is held
+ *        \n once by the search and shared, never copied per model. Each round trains every
+ *        \n surviving model on its own thread of the pool up to the round's epoch budget,
+ *        \n scores it on the validation data and keeps the best 1/eta of them, while the
+ *        \n budget of the next round grows by eta (successive halving).
+ *
+ * @tparam T Scalar type of the models (float or double).
+ */
+template <typename T = double>
+class ModelSearch
+{
+public:
+    /**
+     * @brief Constructs a search that scores the models on held out data.
+     *        \n Ranking by training loss would favour the configurations that overfit, so
+     *        \n the validation rows must not be part of the training rows.
+     *
+     * @param in The training input matrix, one sample per row.
+     * @param out The training output matrix, one sample per row.
+     * @param valid_in The validation input matrix.
+     * @param valid_out The validation output matrix.
+     * @throws std::invalid_argument if the matrices do not match.
+     */
+    ModelSearch(const Matrix<T> &in, const Matrix<T> &out, const Matrix<T> &valid_in, const Matrix<T> &valid_out);
+
+    /**
+     * @brief Adds a candidate configuration.
+     *        \n The model is built right away, so an invalid configuration throws here rather
+     *        \n than in the middle of the search. Its weights come from the seeded Philox
+     *        \n streams of NeuralModel, never from a shared generator (see random.h).
+     *
+     * @param config The configuration to try.
+     * @throws std::invalid_argument if the activations do not match the layers or a name is unknown.
+     */
+    void add(const SearchConfig &config);
+
+    /**
+     * @brief Number of candidate configurations.
+     */
+    int size() const { return static_cast<int>(candidates.size()); }
+
+    /**
+     * @brief Runs successive halving over the candidates.
+     *
+     * @param min_epochs Epoch budget of the first round.
+     * @param max_epochs Epochs the last survivor is trained for.
+     * @param eta Each round keeps 1/eta of the models and multiplies the budget by eta.
+     * @return The index of the best configuration, in the order they were added.
+     * @throws std::invalid_argument if there are no candidates or the budgets are invalid.
+     */
+    int run(int min_epochs = 1, int max_epochs = 27, int eta = 3);
+
+    /**
+     * @brief Configuration of the best model of the last run.
+     * @throws std::invalid_argument if the search has not run.
+     */
+    const SearchConfig &best_config() const;
+
+    /**
+     * @brief The best model of the last run, trained for max_epochs.
+     * @throws std::invalid_argument if the search has not run.
+     */
+    SimpleNeuralNetwork<T> &best();
+
+    /**
+     * @brief Validation loss of the best model of the last run.
+     * @throws std::invalid_argument if the search has not run.
+     */
+    double best_loss() const;
+
+    /**
+     * @brief Saves the best model with SimpleNeuralNetwork::save.
+     *
+     * @param filename The name of the file to save the model.
+     * @throws std::invalid_argument if the search has not run.
+     */
+    void save(std::string filename);
+
+private:
+    struct candidate
+    {
+        SearchConfig config;
+        std::unique_ptr<SimpleNeuralNetwork<T>> model;
+        int epochs = 0;
+        double score = 0;
+    };
+
+    Matrix<T> input;
+    Matrix<T> output;
+    Matrix<T> valid_input;
+    Matrix<T> valid_output;
+    std::vector<candidate> candidates;
+    int winner = -1;
+
+    /*throws unless run() has picked a winner*/
+    const candidate &best_candidate() const;
+};
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * @file QuantizedModel.h
+ * @brief INT8 post-training quantized inference for trained neural network models.
+ */
+
+#ifndef QUANTIZED_NN_H
+#define QUANTIZED_NN_H
+
+#include "nn.h"
+#include <cstdint>
+#include <fstream>
+
+using namespace phoenix;
+
+/**
+ * @brief Inference-only int8 copy of a trained NeuralModel.
+ *        \n Weights are quantized symmetrically per output channel (one scale per row),
+ *        \n the input of every layer symmetrically per tensor with a scale calibrated on
+ *        \n sample rows of the training data. Matrix vector products run on int8 operands
+ *        \n with int32 accumulation and are rescaled to float before the bias and the
+ *        \n activation, so a model takes about a quarter of its float size on disk and in memory.
+ * @note predict reuses internal scratch buffers, one model must not predict from several threads at once.
+ */
+class QuantizedModel {
+    private:
+
+        struct layer {
+            int rows;
+            int cols;
+            /*Activation of the layer, stored as its integer value in the quantized file*/
+            int act;
+            float input_scale;
+            std::vector<float> weight_scale;
+            std::vector<float> bias;
+            std::vector<std::int8_t> weight;
+        };
+
+        std::vector<layer> layers;
+
+        std::vector<std::int8_t> xq;
+        std::vector<std::int32_t> acc;
+        std::vector<float> hidden;
+        std::vector<float> staged_input;
+
+        static int activation_code(const std::string &name);
+        const float *forward(const float *input);
+        void allocate_scratch();
+
+    public:
+        /**
+         * @brief Constructs an empty quantized model, to be filled by load.
+         */
+        QuantizedModel();
+
+        /**
+         * @brief Quantizes a trained model.
+         *
+         * @param model The trained model, e.g. a SimpleNeuralNetwork, LinearRegression or LogisticRegression.
+         * @param calibration Data rows (e.g. the training input) used to calibrate the activation scales.
+         * @param samples Maximum number of calibration rows to run through the model.
+         * @note Calibration runs forward passes of model, which overwrites its last prediction.
+         * @throws std::invalid_argument if the calibration rows do not match the model input.
+         */
+        template <typename T>
+        QuantizedModel(NeuralModel<T> &model, Matrix<T> &calibration, int samples = 256);
+
+        /**
+         * @brief Predicts the output for the given input vector.
+         *
+         * @param predict The input vector for prediction.
+         * @return The predicted output vector, dequantized.
+         * @throws std::invalid_argument if the input size does not match the model.
+         */
+        template <typename T>
+        Vector<T> predict(const Vector<T> &predict);
+
+        /**
+         * @brief Saves the quantized model to a file with the given filename.
+         *
+         * @param filename The name of the file to save the model.
+         */
+        void save(std::string filename);
+
+        /**
+         * @brief Loads a quantized model from a file with the given filename.
+         *
+         * @param filename The name of the file to load the model.
+         */
+        void load(std::string filename);
+};
+
+#endif
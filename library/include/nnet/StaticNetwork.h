@@ -0,0 +1,264 @@
+/**
+ * @file StaticNetwork.h
+ * @brief Compile-time fixed-shape dense network for tiny models, inference only.
+ */
+
+#ifndef STATIC_NN_H
+#define STATIC_NN_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "allocator.hpp"
+#include "parameters.hpp"
+#include "view.hpp"
+
+using namespace phoenix;
+
+namespace phoenix {
+
+/**
+ * @brief Activation policies for StaticNetwork, resolved at compile time and inlined.
+ */
+namespace activation {
+
+struct sigmoid
+{
+    template <typename T>
+    static T apply(T x) { return T(1) / (T(1) + std::exp(-x)); }
+};
+
+struct relu
+{
+    template <typename T>
+    static T apply(T x) { return x > T(0) ? x : T(0); }
+};
+
+struct linear
+{
+    template <typename T>
+    static T apply(T x) { return x; }
+};
+
+}
+
+}
+
+/**
+ * @brief One dense layer with compile-time shape, y = act(W * x (+ b)).
+ *        \n W is stored input-major (column j of W is contiguous), so the inner loop runs
+ *        \n across the outputs and vectorizes without reordering any floating point sum.
+ *
+ * @tparam T Scalar type.
+ * @tparam In Number of inputs.
+ * @tparam Out Number of outputs.
+ */
+template <typename T, std::size_t In, std::size_t Out>
+struct StaticLayer
+{
+    alignas(storage_alignment) T weight[In][Out] = {};
+    alignas(storage_alignment) T bias[Out] = {};
+
+    template <typename Act>
+    void forward(const T *x, T *y, bool add_bias) const
+    {
+        alignas(storage_alignment) T sum[Out];
+        for (std::size_t r = 0; r < Out; r++)
+            sum[r] = add_bias ? bias[r] : T(0);
+
+        for (std::size_t c = 0; c < In; c++)
+        {
+            T xc = x[c];
+            for (std::size_t r = 0; r < Out; r++)
+                sum[r] += weight[c][r] * xc;
+        }
+
+        for (std::size_t r = 0; r < Out; r++)
+            y[r] = Act::template apply<T>(sum[r]);
+    }
+
+    /**
+     * @brief Reads a row-major Out x In weight matrix as written by save.
+     */
+    void read(std::ifstream &file)
+    {
+        T row[In];
+        for (std::size_t r = 0; r < Out; r++)
+        {
+            file.read(reinterpret_cast<char *>(row), sizeof(row));
+            for (std::size_t c = 0; c < In; c++)
+                weight[c][r] = row[c];
+        }
+    }
+};
+
+/**
+ * @brief Dense network whose layer sizes are template parameters.
+ *        \n Every loop bound is a constant and the activations are types rather than
+ *        \n std::function objects, so the compiler can unroll, vectorize and inline the
+ *        \n whole forward pass. The parameters live inside the object; declare large
+ *        \n networks static or allocate them rather than putting them on a small stack.
+ *        \n As in NeuralModel, the bias is added on the hidden layers only.
+ *        \n Build for the target instruction set (e.g. -march=native) to let the compiler use
+ *        \n its full vector width, the library kernels pick theirs at runtime instead.
+ *
+ * @tparam T Scalar type, load() rejects files saved with another precision.
+ * @tparam HiddenAct Activation policy of the hidden layers.
+ * @tparam OutAct Activation policy of the output layer.
+ * @tparam Sizes Number of neurons per layer: input, hidden..., output.
+ */
+template <typename T, typename HiddenAct, typename OutAct, std::size_t... Sizes>
+class BasicStaticNetwork
+{
+    static_assert(sizeof...(Sizes) >= 2, "A network needs at least an input and an output size. ");
+
+    static constexpr std::size_t dims[] = {Sizes...};
+    static constexpr std::size_t num_layers = sizeof...(Sizes) - 1;
+
+    template <std::size_t... I>
+    static auto make_layers(std::index_sequence<I...>) -> std::tuple<StaticLayer<T, dims[I], dims[I + 1]>...>;
+
+    template <std::size_t... I>
+    static auto make_buffers(std::index_sequence<I...>) -> std::tuple<std::array<T, dims[I + 1]>...>;
+
+    using layer_seq = std::make_index_sequence<num_layers>;
+
+    decltype(make_layers(layer_seq{})) layers;
+
+    template <std::size_t... I>
+    void forward(const T *input, T *output, std::index_sequence<I...>) const
+    {
+        decltype(make_buffers(layer_seq{})) neurons;
+        const T *x = input;
+
+        ((std::get<I>(layers).template forward<std::conditional_t<I + 1 == num_layers, OutAct, HiddenAct>>(
+              x, std::get<I>(neurons).data(), I + 1 < num_layers),
+          x = std::get<I>(neurons).data()),
+         ...);
+
+        std::copy(x, x + output_size, output);
+    }
+
+    template <std::size_t... I>
+    void read_weights(std::ifstream &file, std::index_sequence<I...>)
+    {
+        (std::get<I>(layers).read(file), ...);
+    }
+
+    template <std::size_t... I>
+    void read_biases(std::ifstream &file, std::index_sequence<I...>)
+    {
+        (file.read(reinterpret_cast<char *>(std::get<I>(layers).bias), sizeof(std::get<I>(layers).bias)), ...);
+    }
+
+public:
+    static constexpr std::size_t input_size = dims[0];
+    static constexpr std::size_t output_size = dims[num_layers];
+
+    /**
+     * @brief Predicts the output for an input of input_size elements.
+     *
+     * @param input Pointer to the input elements.
+     * @return The predicted output.
+     */
+    std::array<T, output_size> predict(const T *input) const
+    {
+        std::array<T, output_size> output;
+        forward(input, output.data(), layer_seq{});
+        return output;
+    }
+
+    /**
+     * @brief Predicts the output for the given input view, e.g. a row of the data.
+     *
+     * @param input The input vector for prediction.
+     * @return The predicted output.
+     * @throws std::invalid_argument if the input size does not match the network.
+     */
+    std::array<T, output_size> predict(VectorView<const T> input) const
+    {
+        if (static_cast<std::size_t>(input.size()) != input_size)
+        {
+            throw std::invalid_argument("The number of vector rows must be equal to the network input. ");
+        }
+
+        if (input.contiguous())
+            return predict(input.data());
+
+        std::array<T, input_size> staged;
+        copy(input, VectorView<T>(staged.data(), input_size));
+        return predict(staged.data());
+    }
+
+    /**
+     * @brief Loads the parameters from a file written by SimpleNeuralNetwork::save.
+     *
+     * @param filename The name of the file to load the model.
+     * @throws std::invalid_argument if the file was saved with another precision than T or
+     *         \n its layer sizes or number of parameters differ from the network.
+     */
+    void load(std::string filename)
+    {
+        std::ifstream file(filename, std::ios::in | std::ios::binary);
+        if (!file) {
+            std::cerr << "Error: Could not open file " << filename << " for reading\n";
+            return;
+        }
+
+        if (read_precision(file) != sizeof(T))
+        {
+            throw std::invalid_argument("The saved model does not have the precision of the static network. ");
+        }
+
+        int num_inputs, num_hidden, num_outputs;
+        double learning_rate;
+        file.read(reinterpret_cast<char*>(&num_inputs), sizeof(num_inputs));
+        file.read(reinterpret_cast<char*>(&num_hidden), sizeof(num_hidden));
+        file.read(reinterpret_cast<char*>(&num_outputs), sizeof(num_outputs));
+        file.read(reinterpret_cast<char*>(&learning_rate), sizeof(learning_rate));
+
+        bool match = file && num_hidden == static_cast<int>(num_layers) - 1 &&
+                     num_inputs == static_cast<int>(input_size) && num_outputs == static_cast<int>(output_size);
+
+        for (int i = 0; match && i < num_hidden; i++)
+        {
+            int value;
+            file.read(reinterpret_cast<char*>(&value), sizeof(value));
+            match = file && value == static_cast<int>(dims[i + 1]);
+        }
+
+        /*every weight and bias, the output bias included, follows the layer sizes*/
+        std::size_t parameters = 0;
+        for (std::size_t l = 0; l < num_layers; l++)
+            parameters += (dims[l] + 1) * dims[l + 1];
+
+        if (!match || remaining_bytes(file) != parameters * sizeof(T))
+        {
+            throw std::invalid_argument("The saved model does not have the layer sizes of the static network. ");
+        }
+
+        read_weights(file, layer_seq{});
+
+        /*the output bias is not used by the network, only the hidden biases are read*/
+        read_biases(file, std::make_index_sequence<num_layers - 1>{});
+        file.close();
+    }
+};
+
+/**
+ * @brief Double precision fixed-shape network with Act on the hidden layers and a linear
+ *        \n output, the default layout of SimpleNeuralNetwork.
+ *        \n e.g. StaticNetwork<activation::sigmoid, 256, 100, 10> for a 256-100-10 classifier.
+ */
+template <typename Act, std::size_t... Sizes>
+using StaticNetwork = BasicStaticNetwork<double, Act, activation::linear, Sizes...>;
+
+#endif
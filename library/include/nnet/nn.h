@@ -9,39 +9,167 @@
 #include "Vector.hpp"
 #include "utils.h"
 #include <functional>
+#include <memory>
+#include <string>
 #include "tensor.hpp"
+#include "parameters.hpp"
+#include "optimizer.h"
+#include "random.h"
 
 using namespace phoenix;
 
+class QuantizedModel;
+
+/**
+ * @brief How an epoch of training is spread over the library thread pool.
+ */
+enum class TrainingMode
+{
+    serial,      /**< One thread walks the data, the default. */
+    synchronous, /**< Every mini-batch is split over the threads and their gradients are summed before one update. */
+    hogwild      /**< Every thread trains on its own shard of the rows and updates the shared weights without locks. */
+};
+
 /**
 * @brief A class for implementing a neural network model.
 *        \n This class contains the necessary data members and methods for creating, 
 *        \n training, and using a neural network model.
+*
+* @tparam T Scalar type of the weights, biases and activations (float or double).
 */
+template <typename T = double>
 class NeuralModel {
 
 private:
-    Matrix<double> feature;
-    Matrix<double> label; 
+    Matrix<T> feature;
+    Matrix<T> label; 
     std::initializer_list<int> hid_list; 
     std::vector<int> hiddn;
 
     /*number of hidden neuron in each layer*/
-    std::vector<Vector<double>> target;
+    std::vector<Vector<T>> target;
     int no_hid = 0;
     double learning_rate = 0.01;
     
+   /*activation of a layer, resolved once to its whole-span kernels*/
    struct act{
-    std::function<double(double)> activation;
-    std::function<double(double)> derivative;
+    const ActivationKernels<T> *kernels;
+    std::string name;
    }; 
 
    std::vector<act> A;    
 
+   /*W * h + b of each layer in the last forward pass, the activations are in the network*/
+   std::vector<Vector<T>> pre_activation;
+
+   /*error terms of each layer, output layer first, sized by NNBuild*/
+   std::vector<Vector<T>> layer_error;
+
+   /*input of the last forward pass, it is not copied into the network*/
+   VectorView<const T> layer_input{nullptr, 0};
+
+   /*number of samples per training step*/
+   int batch_size = 1;
+
+   /*pre-activations, activations and error terms of every layer for a mini-batch, one row per sample*/
+   struct batch_workspace {
+    std::vector<Matrix<T>> pre;
+    std::vector<Matrix<T>> layers;
+    std::vector<Matrix<T>> error;
+    MatrixView<const T> input{nullptr, 0, 0, 0};
+    int rows = 0;
+    /*rows picked by index for subset training and evaluation, grown on demand*/
+    Matrix<T> staged_input{0, 0};
+    Matrix<T> staged_output{0, 0};
+   };
+
+   batch_workspace batch;
+
+   /*how an epoch is spread over the thread pool*/
+   TrainingMode training_mode = TrainingMode::serial;
+
+   /*update rule of the batched path, nullptr is plain SGD at learning_rate*/
+   std::shared_ptr<Optimizer<T>> optimizer;
+
+   /*distribution and seed of the initial weights, layer l draws from stream l of the seed*/
+   Initializer initializer = Initializer::xavier_uniform;
+   std::uint64_t seed = default_seed;
+
+   /*redraws every weight layer from its stream and zeroes the biases*/
+   void draw_parameters();
+
+   /*averaged loss gradient handed to the optimizer, laid out like params*/
+   ParameterBuffer<T> gradient;
+
+   /*one workspace, gradient and error sum per shard of a data-parallel epoch*/
+   std::vector<batch_workspace> replicas;
+   std::vector<ParameterBuffer<T>> gradients;
+   std::vector<double> replica_error;
+
+   /*grows the buffers of a workspace to hold rows samples*/
+   void reserve_batch(batch_workspace &ws, int rows);
+
+   /*makes room for shards workspaces of rows samples, with a gradient buffer each if needed*/
+   void reserve_replicas(int shards, int rows, bool with_gradients);
+
+   /*forward pass of a mini-batch into a workspace*/
+   void forward_batch(batch_workspace &ws, MatrixView<const T> input);
+
+   /*error terms of every layer for the mini-batch held by a workspace, returns the summed loss*/
+   double batch_errors(batch_workspace &ws, MatrixView<const T> expected_output);
+
+   /*target = beta * target + scale * gradient of the workspace batch, target is laid out like params*/
+   void batch_gradient(batch_workspace &ws, ParameterBuffer<T> &target, T scale, T beta);
+
+   /*forward, errors and update of one mini-batch in a workspace, returns the summed loss*/
+   double batch_step(batch_workspace &ws, MatrixView<const T> input, MatrixView<const T> target);
+
+   /*copies up to count of the indexed rows starting at rows[first] into the staging rows of a workspace, returns how many*/
+   int gather_rows(batch_workspace &ws, const Matrix<T> &in, const Matrix<T> &out, const std::vector<int> &rows, std::size_t first, int count);
+
+   /*runs forward, errors and update for consecutive mini-batches of the indexed rows rows[first, last) in a workspace*/
+   double train_indexed(batch_workspace &ws, const Matrix<T> &in, const Matrix<T> &out, const std::vector<int> &rows, std::size_t first, std::size_t last);
+
+   /*runs forward, errors and update for consecutive mini-batches of rows [first, last) in a workspace*/
+   double train_rows(batch_workspace &ws, const Matrix<T> &in, const Matrix<T> &out, int first, int last);
+
+   /*synchronous data-parallel step on rows [first, first + n)*/
+   double synchronous_step(const Matrix<T> &in, const Matrix<T> &out, int first, int n);
+
+   /*reads the trained parameters and activations to build an int8 copy*/
+   friend class QuantizedModel;
+
   protected:
 
-  Tensor<double> network; /**< Tensor network */
-  std::vector<Vector<double>> B; /**< Bias of network */        
+  Tensor<T> network; /**< Tensor network */
+  std::vector<Vector<T>> B; /**< Bias of network */        
+  ParameterBuffer<T> params; /**< Weights and biases in one buffer, the network weights and B alias it */
+
+  /**
+   * @brief Activation of weight layer l, 0 is the first hidden layer and the last one the output.
+   * @throws std::out_of_range if the model has no activation configured for layer l.
+   */
+  Activation layer_activation(int l) const { return A.at(l).kernels->kind; }
+
+  /**
+   * @brief Checks that the model is one affine map followed by an output activation, as
+   *        \n needed by the closed-form fits: linear layers, square after the first one.
+   *
+   * @param output Activation the output layer must have.
+   * @throws std::invalid_argument if an activation or a layer shape does not match.
+   */
+  void check_affine_layers(Activation output) const;
+
+  /**
+   * @brief Loads a fitted affine map into the model and reports its training loss.
+   *        \n The first layer gets the solution, the later layers become identities.
+   *
+   * @param solution (inputs + 1) x outputs coefficients, the intercepts in the last row.
+   * @param in The training input matrix.
+   * @param out The training output matrix.
+   * @return The loss of train() averaged over the rows, also printed as "Fit----- Error: ".
+   */
+  double load_linear_solution(const Matrix<double> &solution, const Matrix<T> &in, const Matrix<T> &out);
  
 
 public:
@@ -58,24 +186,151 @@ public:
      * @param hidden_neurons An initializer list specifying the number of hidden neurons in each layer.
      * @param rate The learning rate of the neural network model.
      */
-    NeuralModel (Matrix<double> &in,
-                 Matrix<double> &out,
+    NeuralModel (Matrix<T> &in,
+                 Matrix<T> &out,
                  std::initializer_list<int> hidden_neurons,
                  double rate );
 
+    /**
+     * @brief Constructs a neural network model object with hidden layer sizes chosen at run time.
+     *
+     * @param in The input matrix.
+     * @param out The output matrix.
+     * @param hidden_neurons The number of hidden neurons in each layer.
+     * @param rate The learning rate of the neural network model.
+     */
+    NeuralModel (Matrix<T> &in,
+                 Matrix<T> &out,
+                 const std::vector<int> &hidden_neurons,
+                 double rate );
+
     /**
      * @brief Destructs a neural network model.
      */
     ~NeuralModel()  {};
 
+    /**
+     * @brief Sets the number of samples per training step.
+     *        \n With more than one sample, forward and backward passes run on the whole
+     *        \n batch with matrix-matrix products and the gradient is averaged over it.
+     *
+     * @param size The mini-batch size, 1 trains sample by sample.
+     * @throws std::invalid_argument if size is smaller than 1.
+     */
+    void setBatchSize(int size);
+
+    /**
+     * @brief Get the number of samples per training step.
+     */
+    int getBatchSize() const { return batch_size; }
+
+    /**
+     * @brief Selects how training is spread over the threads of the library pool.
+     *        \n Synchronous training computes the same averaged gradient as a serial
+     *        \n mini-batch step, with each thread owning a replica of the activations; it
+     *        \n needs a batch size of at least the number of threads to keep them busy.
+     *        \n Hogwild training gives every thread a contiguous shard of the rows and lets
+     *        \n them update the weights concurrently without synchronization, so updates
+     *        \n may be lost or read half-applied and results are not reproducible.
+     *
+     * @param mode The training mode, TrainingMode::serial by default.
+     */
+    void setTrainingMode(TrainingMode mode) { training_mode = mode; }
+
+    /**
+     * @brief Get how training is spread over the threads.
+     */
+    TrainingMode getTrainingMode() const { return training_mode; }
+
+    /**
+     * @brief Sets the rule that updates the weights and biases from their gradient,
+     *        \n e.g. std::make_shared<Adam<T>>(0.001). The optimizer gets the loss gradient
+     *        \n averaged over each mini-batch and keeps its own learning rate and state.
+     *
+     * @param opt The optimizer, nullptr restores plain SGD at the model learning rate.
+     * @note Hogwild training only supports plain SGD.
+     */
+    void setOptimizer(std::shared_ptr<Optimizer<T>> opt);
+
+    /**
+     * @brief Redraws the weights from a distribution and zeroes the biases, e.g.
+     *        \n Initializer::he_normal after configuring relu layers. Models are built with
+     *        \n Initializer::xavier_uniform and the default seed. Layer l always draws from
+     *        \n stream l of the seed, so the same seed gives the same weights on any thread.
+     *        \n The optimizer state is reset.
+     *
+     * @param kind The distribution of the weights.
+     * @param seed Seed of the weight streams.
+     */
+    void initialize(Initializer kind, std::uint64_t seed = default_seed);
+
+    /**
+     * @brief Classification accuracy of the model on a data set, the fraction of rows whose
+     *        \n largest output is at the position of the largest expected value (one-hot labels).
+     *        \n The rows are run through the network in mini-batches.
+     *
+     * @param in The input matrix, one sample per row.
+     * @param expected The expected output matrix, one sample per row.
+     * @return The accuracy between 0 and 1.
+     * @throws std::invalid_argument if the matrices do not match the network or each other.
+     */
+    double accuracy(const Matrix<T> &in, const Matrix<T> &expected);
+
+    /**
+     * @brief Mean loss of the model on a data set, on the scale of the training error:
+     *        \n the cross-entropy for a softmax output layer, half the squared error otherwise.
+     *        \n The rows are run through the network in mini-batches and the weights are not changed.
+     *
+     * @param in The input matrix, one sample per row.
+     * @param expected The expected output matrix, one sample per row.
+     * @return The loss averaged over the rows.
+     * @throws std::invalid_argument if the matrices do not match the network or each other.
+     */
+    double loss(const Matrix<T> &in, const Matrix<T> &expected);
+
+    /**
+     * @brief Trains one epoch on the rows of in and out listed in rows, in that order.
+     *        \n Nothing is copied sample by sample; with mini-batches each batch is gathered into
+     *        \n reused staging rows. The training mode applies as in train: synchronous training
+     *        \n splits every gathered batch over the threads, hogwild training gives every thread
+     *        \n a contiguous part of rows to gather and train on.
+     *
+     * @param in The input matrix, one sample per row.
+     * @param out The expected output matrix, one sample per row.
+     * @param rows Indices of the rows to train on, e.g. the training part of a fold.
+     * @return The training error averaged over the rows.
+     * @throws std::invalid_argument if an index is outside the data, or for hogwild training with an optimizer.
+     */
+    double train_subset(const Matrix<T> &in, const Matrix<T> &out, const std::vector<int> &rows);
+
+    /**
+     * @brief Mean loss on the rows of a data set listed in rows, see loss above.
+     * @throws std::invalid_argument if the matrices do not match or an index is outside the data.
+     */
+    double loss(const Matrix<T> &in, const Matrix<T> &expected, const std::vector<int> &rows);
+
+    /**
+     * @brief Classification accuracy on the rows of a data set listed in rows, see accuracy above.
+     * @throws std::invalid_argument if the matrices do not match or an index is outside the data.
+     */
+    double accuracy(const Matrix<T> &in, const Matrix<T> &expected, const std::vector<int> &rows);
+
   protected:
     /**
      * @brief Configures the activation functions for the neural network model.
      *
-     * @param act_function An initializer list specifying the activation functions for each layer.
+     * @param act_function An initializer list specifying the activation functions for each layer:
+     *        \n "sigmoid", "relu", "linear", "tanh", "leaky_relu", "gelu" or "softmax".
+     *        \n A softmax output layer is trained with the cross-entropy loss.
+     * @throws std::invalid_argument if a name is unknown or softmax is used on a hidden layer.
      */
     void NNConnfigure(std::initializer_list<std::string> act_function);
 
+    /**
+     * @brief Configures the activation functions from names chosen at run time, see above.
+     */
+    void NNConnfigure(const std::vector<std::string> &act_function);
+
     /**
      * @brief Builds the neural network model with the specified input size, output size, and hidden layer sizes.
      *
@@ -88,23 +343,83 @@ public:
     /**
      * @brief Performs forward propagation for the given input.
      *
-     * @param input The input vector for the neural network model.
+     * @param input The input vector for the neural network model, e.g. a row view of the data.
+     * @note The input is read in place and must stay alive until back propagation has run.
      */
-    void forward_propagation(const Vector<double> &input);
+    void forward_propagation(VectorView<const T> input);
 
     /**
      * @brief Performs back propagation to update the weights and biases of the neural network model.
+     *        \n Runs in the buffers sized by NNBuild, without allocating.
      *
      * @param expected_output The expected output vector for the neural network model.
+     * @return The loss of the sample before the update, see output_loss.
      */
-    void back_propagation(const Vector<double> &expected_output);
+    T back_propagation(VectorView<const T> expected_output);
 
     /**
      * @brief Predicts the output for the given input using the trained neural network model.
      *
      * @return The predicted output vector for the given input.
      */
-    Vector<double> NNPredicted();
+    Vector<T> NNPredicted();
+
+    /**
+     * @brief Returns a view on the output layer of the last forward pass, without copying it.
+     *
+     * @return The view on the predicted output vector.
+     */
+    VectorView<const T> NNOutput();
+
+    /**
+     * @brief Performs forward propagation for a mini-batch, one sample per row.
+     *
+     * @param input The input rows, e.g. a block of the data.
+     * @note The input is read in place and must stay alive until back propagation has run.
+     * @throws std::invalid_argument if the number of columns does not match the network input.
+     */
+    void forward_batch(MatrixView<const T> input);
+
+    /**
+     * @brief Performs back propagation for the last mini-batch, updating the weights and
+     *        \n biases once with the gradient averaged over its rows.
+     *
+     * @param expected_output The expected output rows of the mini-batch.
+     * @return The loss summed over the rows before the update.
+     * @throws std::invalid_argument if the shape does not match the last forward batch.
+     */
+    double back_propagation_batch(MatrixView<const T> expected_output);
+
+    /**
+     * @brief Returns a view on the output rows of the last mini-batch, without copying them.
+     */
+    MatrixView<const T> NNBatchOutput();
+
+    /**
+     * @brief Writes the output error expected - output and returns the loss of the sample in the
+     *        \n same pass: the cross-entropy for a softmax output layer, the squared error otherwise.
+     *
+     * @param expected The expected output.
+     * @param output The network output.
+     * @param error Output array with one element per output.
+     * @throws std::invalid_argument if expected and output differ in size.
+     */
+    T output_loss(VectorView<const T> expected, VectorView<const T> output, T *error) const;
+
+    /**
+     * @brief True if training has to go through train_batches rather than the sample by sample loop.
+     */
+    bool batched_training() const { return batch_size > 1 || training_mode != TrainingMode::serial || optimizer; }
+
+    /**
+     * @brief Trains one epoch over the data in mini-batches of getBatchSize() rows,
+     *        \n spread over the thread pool as selected by setTrainingMode.
+     *
+     * @param in The input matrix, one sample per row.
+     * @param out The expected output matrix, one sample per row.
+     * @return The error summed over all samples.
+     */
+    double train_batches(const Matrix<T> &in, const Matrix<T> &out);
 };
 
 
@@ -0,0 +1,187 @@
+/**
+ * @file optimizer.h
+ * @brief Parameter update rules used by NeuralModel during training.
+ */
+
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <cstddef>
+#include <vector>
+#include "view.hpp"
+
+using namespace phoenix;
+
+/**
+ * @brief Base class of the optimizers.
+ *        \n The model hands over all of its parameters and their averaged loss gradient as
+ *        \n two flat buffers, laid out like ParameterBuffer, once per training step. Each
+ *        \n optimizer updates the parameters and its own state in a single fused pass, split
+ *        \n over the thread pool for large models when PARALLEL is enabled.
+ *
+ * @tparam T Scalar type of the model (float or double).
+ */
+template <typename T = double>
+class Optimizer
+{
+public:
+    virtual ~Optimizer() = default;
+
+    /**
+     * @brief Applies one update to the parameters.
+     *
+     * @param params All parameters of the model, updated in place.
+     * @param gradient Gradient of the loss with respect to params.
+     * @throws std::invalid_argument if the views differ in size or are not contiguous.
+     */
+    void step(VectorView<T> params, VectorView<const T> gradient);
+
+    /**
+     * @brief Clears the state, the next step starts from zero moments.
+     */
+    void reset();
+
+    /**
+     * @brief Number of steps taken since the last reset.
+     */
+    long steps() const { return t; }
+
+protected:
+    /**
+     * @brief Called once per step, before any update, e.g. to compute bias corrections.
+     */
+    virtual void prepare() {}
+
+    /**
+     * @brief Grows or clears the state for n parameters.
+     */
+    virtual void resize(std::size_t n) = 0;
+
+    /**
+     * @brief Updates n parameters starting at offset in the flat buffers.
+     */
+    virtual void update(std::size_t offset, int n, T *params, const T *gradient) = 0;
+
+    long t = 0;
+    std::size_t size = 0;
+};
+
+/**
+ * @brief Plain stochastic gradient descent, p -= rate * g.
+ */
+template <typename T = double>
+class SGD : public Optimizer<T>
+{
+public:
+    /**
+     * @param rate The learning rate.
+     */
+    explicit SGD(double rate = 0.01);
+
+protected:
+    void resize(std::size_t /*n*/) override {}
+    void update(std::size_t offset, int n, T *params, const T *gradient) override;
+
+private:
+    T rate;
+};
+
+/**
+ * @brief SGD with classical momentum, v = mu * v - rate * g, p += v.
+ */
+template <typename T = double>
+class Momentum : public Optimizer<T>
+{
+public:
+    /**
+     * @param rate The learning rate.
+     * @param mu The momentum coefficient.
+     */
+    explicit Momentum(double rate = 0.01, double mu = 0.9);
+
+protected:
+    void resize(std::size_t n) override;
+    void update(std::size_t offset, int n, T *params, const T *gradient) override;
+
+    T rate;
+    T mu;
+    std::vector<T> velocity;
+};
+
+/**
+ * @brief SGD with Nesterov momentum, v = mu * v - rate * g, p += mu * v - rate * g.
+ */
+template <typename T = double>
+class Nesterov : public Momentum<T>
+{
+public:
+    /**
+     * @param rate The learning rate.
+     * @param mu The momentum coefficient.
+     */
+    explicit Nesterov(double rate = 0.01, double mu = 0.9);
+
+protected:
+    void update(std::size_t offset, int n, T *params, const T *gradient) override;
+};
+
+/**
+ * @brief RMSProp, s = decay * s + (1 - decay) * g^2, p -= rate * g / (sqrt(s) + eps).
+ */
+template <typename T = double>
+class RMSProp : public Optimizer<T>
+{
+public:
+    /**
+     * @param rate The learning rate.
+     * @param decay The decay of the squared gradient average.
+     * @param eps Added to the root mean square to avoid a division by zero.
+     */
+    explicit RMSProp(double rate = 0.001, double decay = 0.9, double eps = 1e-8);
+
+protected:
+    void resize(std::size_t n) override;
+    void update(std::size_t offset, int n, T *params, const T *gradient) override;
+
+private:
+    T rate;
+    T decay;
+    T eps;
+    std::vector<T> square;
+};
+
+/**
+ * @brief Adam, bias corrected first and second moment estimates of the gradient.
+ */
+template <typename T = double>
+class Adam : public Optimizer<T>
+{
+public:
+    /**
+     * @param rate The learning rate.
+     * @param beta1 The decay of the first moment.
+     * @param beta2 The decay of the second moment.
+     * @param eps Added to the root of the second moment to avoid a division by zero.
+     */
+    explicit Adam(double rate = 0.001, double beta1 = 0.9, double beta2 = 0.999, double eps = 1e-8);
+
+protected:
+    void prepare() override;
+    void resize(std::size_t n) override;
+    void update(std::size_t offset, int n, T *params, const T *gradient) override;
+
+private:
+    double rate;
+    double beta1;
+    double beta2;
+    double eps;
+
+    /*rate and eps of the current step with the bias correction folded in*/
+    T step_rate = 0;
+    T step_eps = 0;
+
+    std::vector<T> first;
+    std::vector<T> second;
+};
+
+#endif
@@ -5,20 +5,27 @@
 
 #include "nn.h"
 #include "nn_interface.h"
+#include "sampler.h"
 #include <fstream>
 
 using namespace phoenix;
 
 /**
  * @brief Neural Networl APi for solving simple and dense nn.
+ *
+ * @tparam T Scalar type of the model (float or double).
  */
-class SimpleNeuralNetwork : public NeuralModel, public INeuralNetwork {
+template <typename T = double>
+class SimpleNeuralNetwork : public NeuralModel<T>, public INeuralNetwork<T> {
     private:
 
-        Matrix<double> input;
-        Matrix<double> output;
+        Matrix<T> input;
+        Matrix<T> output;
         std::vector<int> H;
 
+        /*row order of each epoch, nullptr trains on the rows in order*/
+        std::shared_ptr<RowSampler> sampler;
+
         int num_inputs;
         int num_hidden;
         int num_outputs;
@@ -34,11 +41,25 @@ class SimpleNeuralNetwork : public NeuralModel, public INeuralNetwork {
          * @param rhidden_neurons The number of hidden neurons in each layer.
          * @param rrate The learning rate of the model.
          */
-        SimpleNeuralNetwork(Matrix<double> &rin,
-                            Matrix<double> &rout,
+        SimpleNeuralNetwork(Matrix<T> &rin,
+                            Matrix<T> &rout,
                             std::initializer_list<int> rhidden_neurons,
                             double rrate);
 
+        /**
+         * @brief Constructs a simple neural network object with hidden layer sizes chosen at run time.
+         *        \n The matrices are shared with the caller, not copied.
+         *
+         * @param rin The input matrix for the model.
+         * @param rout The output matrix for the model.
+         * @param rhidden_neurons The number of hidden neurons in each layer.
+         * @param rrate The learning rate of the model.
+         */
+        SimpleNeuralNetwork(Matrix<T> &rin,
+                            Matrix<T> &rout,
+                            const std::vector<int> &rhidden_neurons,
+                            double rrate);
+
          /**
          * @brief Constructs a simple neural network object with default values.
          */
@@ -51,13 +72,30 @@ class SimpleNeuralNetwork : public NeuralModel, public INeuralNetwork {
          */
         void train(const int epochs = 100);
 
+        /**
+         * @brief Trains the model for one epoch without printing.
+         *
+         * @return The training error of the epoch averaged over the samples.
+         */
+        double train_epoch();
+
+        /**
+         * @brief Trains each epoch on the rows in the order drawn by a sampler, e.g.
+         *        \n std::make_shared<RowSampler>(rows) for a fresh shuffle every epoch. The data
+         *        \n is not moved: every epoch goes through NeuralModel::train_subset, which gathers
+         *        \n the mini-batches by index and follows the training mode like an epoch in order.
+         *
+         * @param rows The sampler, nullptr restores training on the rows in order.
+         */
+        void setSampler(std::shared_ptr<RowSampler> rows) { sampler = rows; }
+
         /**
          * @brief Predicts the output for the given input vector.
          *
          * @param predict The input vector for prediction.
          * @return The predicted output vector.
          */
-        Vector<double> predict(const Vector<double> &predict);
+        Vector<T> predict(const Vector<T> &predict);
 
         /**
          * @brief Configures the activation functions for the model.
@@ -66,10 +104,18 @@ class SimpleNeuralNetwork : public NeuralModel, public INeuralNetwork {
          */
         void configure(std::initializer_list<std::string> &act_value);
 
+        /**
+         * @brief Configures the activation functions from names chosen at run time.
+         *
+         * @param act_value The list of activation function names.
+         */
+        void configure(const std::vector<std::string> &act_value);
+
         /**
          * @brief Saves the model to a file with the given filename.
          *
          * @param filename The name of the file to save the model.
+         * @note Weights and biases are written as T, a model is loaded back with the same T.
          */
         void save(std::string filename);
 
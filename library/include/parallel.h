@@ -1,10 +1,19 @@
 #pragma once
 
-#include <boost/thread.hpp>
+#include <type_traits>
+#include <vector>
 #include "Matrix.hpp"
+#include "simd.h"
+#include "threadpool.h"
 
 using namespace phoenix;
 
+/*Below these sizes a kernel is cheaper to run on the calling thread than to hand to the pool*/
+constexpr std::size_t gemv_parallel_threshold = 1 << 16; /*multiply-adds per call*/
+constexpr std::size_t gemv_min_chunk = 1 << 14;          /*multiply-adds per chunk*/
+constexpr std::size_t vadd_parallel_threshold = 1 << 16; /*elements per call*/
+constexpr std::size_t vadd_min_chunk = 1 << 14;          /*elements per chunk*/
+
 template <typename T>
 void matrix_vector_multiply_thread(const Matrix<T> &m2, const Vector<T> &v1,
                                    Vector<T> &result, std::size_t row_start, std::size_t row_end);
@@ -18,61 +27,326 @@ template <typename T>
 void vector_vector_add(const Vector<T> &v1, const Vector<T> &v2, Vector<T> &result, int num_threads);
 template <typename T>
 void vector_addition_thread(const Vector<T> &v1, const Vector<T> &v2, Vector<T> &result, int start, int end);
+template <typename A, typename X, typename Y>
+void matrix_vector_multiply(MatrixView<A> m2, VectorView<X> v1, VectorView<Y> result);
+template <typename A, typename X, typename Y>
+void matrix_vector_multiply(MatrixView<A> m2, VectorView<X> v1, VectorView<Y> result, std::size_t num_threads);
+template <typename A, typename X, typename Y>
+void matrix_transpose_vector_multiply(MatrixView<A> m2, VectorView<X> v1, VectorView<Y> result);
+template <typename A, typename X, typename Y>
+void matrix_transpose_vector_multiply(MatrixView<A> m2, VectorView<X> v1, VectorView<Y> result, std::size_t num_threads);
+template <typename X, typename Z, typename Y>
+void vector_vector_add(VectorView<X> v1, VectorView<Z> v2, VectorView<Y> result);
+template <typename X, typename Z, typename Y>
+void vector_vector_add(VectorView<X> v1, VectorView<Z> v2, VectorView<Y> result, int num_threads);
+
+/**
+ * Returns a per thread scratch buffer of at least n elements, used to stage strided operands.
+ *
+ * @tparam T The type of the elements.
+ * @tparam Slot Distinguishes buffers that are in use at the same time.
+ */
+template <typename T, int Slot>
+T *staging_buffer(std::size_t n)
+{
+    thread_local std::vector<T> buffer;
+    if (buffer.size() < n)
+        buffer.resize(n);
+    return buffer.data();
+}
 
 /**
- * Multiplies a matrix and a vector in a specified range of rows using multiple threads.
+ * Multiplies a matrix view and a vector view, result = m2 * v1.
+ * Matrices with contiguous rows are handed to simd::gemv, a strided vector operand is
+ * staged through a per thread buffer and views with strided rows (such as a transposed
+ * view) are computed by the strided gemm kernel.
  *
  * @param m2 The matrix to multiply.
  * @param v1 The vector to multiply.
  * @param result The resulting vector.
- * @param row_start The index of the first row to multiply.
- * @param row_end The index of the last row to multiply.
- * @tparam T The type of the elements in the matrix and vector.
+ * @tparam A, X, Y Element types of the views, equal up to const.
+ * @throws std::invalid_argument if the view sizes do not match.
  */
-template <typename T>
-void matrix_vector_multiply_thread(const Matrix<T> &m2, const Vector<T> &v1,
-                                   Vector<T> &result, std::size_t row_start, std::size_t row_end)
+template <typename A, typename X, typename Y>
+void matrix_vector_multiply(MatrixView<A> m2, VectorView<X> v1, VectorView<Y> result)
 {
-    for (std::size_t k = row_start; k < row_end; ++k)
+    using T = std::remove_const_t<A>;
+
+    if (v1.size() != m2.getCols() || result.size() != m2.getRows())
+    {
+        throw std::invalid_argument("The number of vector rows must be equal to Matrix column. ");
+    }
+
+    if (!m2.contiguousRows())
+    {
+        gemm(m2.getRows(), 1, m2.getCols(), T(1), m2.data(), m2.rowStride(), m2.colStride(),
+             v1.data(), v1.stride(), 1, T(0), result.data(), result.stride(), 1);
+        return;
+    }
+
+    const T *x = v1.data();
+    if (!v1.contiguous())
     {
-        T sum = 0;
-        for (std::size_t i = 0; i < v1.getRows(); ++i)
-        {
-            sum += v1[i] * m2(k, i);
-        }
-        result[k] = sum;
+        T *staged = staging_buffer<T, 0>(v1.size());
+        copy(v1, VectorView<T>(staged, v1.size()));
+        x = staged;
     }
+
+    if (result.contiguous())
+    {
+        simd::gemv(m2.getRows(), m2.getCols(), m2.data(), m2.rowStride(), x, result.data());
+        return;
+    }
+
+    T *y = staging_buffer<T, 1>(result.size());
+    simd::gemv(m2.getRows(), m2.getCols(), m2.data(), m2.rowStride(), x, y);
+    copy(VectorView<const T>(y, result.size()), result);
 }
 
 /**
- * Multiplies a matrix and a vector using a specified number of threads.
+ * Multiplies a matrix view and a vector view on the library thread pool.
+ * Products smaller than gemv_parallel_threshold run on the calling thread.
  *
  * @param m2 The matrix to multiply.
  * @param v1 The vector to multiply.
  * @param result The resulting vector.
- * @param num_threads The number of threads to use.
- * @tparam T The type of the elements in the matrix and vector.
+ * @param num_threads The maximum number of threads to use.
+ * @tparam A, X, Y Element types of the views, equal up to const.
  */
-template <typename T>
-void matrix_vector_multiply(const Matrix<T> &m2, const Vector<T> &v1, Vector<T> &result, std::size_t num_threads)
+template <typename A, typename X, typename Y>
+void matrix_vector_multiply(MatrixView<A> m2, VectorView<X> v1, VectorView<Y> result, std::size_t num_threads)
 {
+    using T = std::remove_const_t<A>;
 
-    std::vector<boost::thread> threads(num_threads);
+    std::size_t rows = m2.getRows();
+    std::size_t cols = std::max(m2.getCols(), 1);
 
-    std::size_t rows_per_thread = m2.getRows() / num_threads;
+    if (num_threads <= 1 || rows * cols < gemv_parallel_threshold || !m2.contiguousRows())
+    {
+        matrix_vector_multiply(m2, v1, result);
+        return;
+    }
 
-    for (std::size_t i = 0; i < num_threads; ++i)
+    if (v1.size() != m2.getCols())
     {
-        std::size_t row_start = i * rows_per_thread;
-        std::size_t row_end = (i == num_threads - 1) ? m2.getRows() : (i + 1) * rows_per_thread;
-        threads[i] = boost::thread(matrix_vector_multiply_thread<T>, std::cref(m2), std::cref(v1),
-                                   std::ref(result), row_start, row_end);
+        throw std::invalid_argument("The number of vector rows must be equal to Matrix column. ");
     }
 
-    for (auto &thread : threads)
+    /*stage a strided operand once instead of once per chunk*/
+    VectorView<const T> x = v1;
+    if (!v1.contiguous())
     {
-        thread.join();
+        T *staged = staging_buffer<T, 0>(v1.size());
+        copy(v1, VectorView<T>(staged, v1.size()));
+        x = VectorView<const T>(staged, v1.size());
     }
+
+    /*a few chunks per thread for balance, rounded to the 4 row block of the kernel*/
+    std::size_t grain = std::max(gemv_min_chunk / cols, rows / (4 * num_threads));
+    grain = std::max<std::size_t>((grain + 3) & ~std::size_t(3), 4);
+
+    parallel_for(0, rows, grain, [&](std::size_t row_start, std::size_t row_end)
+                 {
+                     int count = static_cast<int>(row_end - row_start);
+                     matrix_vector_multiply(m2.block(static_cast<int>(row_start), 0, count, m2.getCols()), x,
+                                            result.segment(static_cast<int>(row_start), count));
+                 });
+}
+
+/**
+ * Multiplies the transpose of a matrix view with a vector view, result = m2^T * v1,
+ * without forming the transpose. Matrices with contiguous rows are handed to
+ * simd::gemv_transposed, other views are multiplied through their transposed view.
+ *
+ * @param m2 The matrix whose transpose is multiplied.
+ * @param v1 The vector to multiply, one element per row of m2.
+ * @param result The resulting vector, one element per column of m2.
+ * @tparam A, X, Y Element types of the views, equal up to const.
+ * @throws std::invalid_argument if the view sizes do not match.
+ */
+template <typename A, typename X, typename Y>
+void matrix_transpose_vector_multiply(MatrixView<A> m2, VectorView<X> v1, VectorView<Y> result)
+{
+    using T = std::remove_const_t<A>;
+
+    if (v1.size() != m2.getRows() || result.size() != m2.getCols())
+    {
+        throw std::invalid_argument("The number of vector rows must be equal to Matrix row. ");
+    }
+
+    if (!m2.contiguousRows())
+    {
+        matrix_vector_multiply(m2.transpose(), v1, result);
+        return;
+    }
+
+    const T *x = v1.data();
+    if (!v1.contiguous())
+    {
+        T *staged = staging_buffer<T, 0>(v1.size());
+        copy(v1, VectorView<T>(staged, v1.size()));
+        x = staged;
+    }
+
+    if (result.contiguous())
+    {
+        simd::gemv_transposed(m2.getRows(), m2.getCols(), m2.data(), m2.rowStride(), x, result.data());
+        return;
+    }
+
+    T *y = staging_buffer<T, 1>(result.size());
+    simd::gemv_transposed(m2.getRows(), m2.getCols(), m2.data(), m2.rowStride(), x, y);
+    copy(VectorView<const T>(y, result.size()), result);
+}
+
+/**
+ * Multiplies the transpose of a matrix view with a vector view on the library thread pool.
+ * The columns of m2 (elements of result) are split between the threads, so no partial
+ * sums have to be reduced. Products smaller than gemv_parallel_threshold run on the calling thread.
+ *
+ * @param m2 The matrix whose transpose is multiplied.
+ * @param v1 The vector to multiply, one element per row of m2.
+ * @param result The resulting vector, one element per column of m2.
+ * @param num_threads The maximum number of threads to use.
+ * @tparam A, X, Y Element types of the views, equal up to const.
+ */
+template <typename A, typename X, typename Y>
+void matrix_transpose_vector_multiply(MatrixView<A> m2, VectorView<X> v1, VectorView<Y> result, std::size_t num_threads)
+{
+    using T = std::remove_const_t<A>;
+
+    std::size_t rows = std::max(m2.getRows(), 1);
+    std::size_t cols = m2.getCols();
+
+    if (num_threads <= 1 || rows * cols < gemv_parallel_threshold || !m2.contiguousRows())
+    {
+        matrix_transpose_vector_multiply(m2, v1, result);
+        return;
+    }
+
+    if (v1.size() != m2.getRows())
+    {
+        throw std::invalid_argument("The number of vector rows must be equal to Matrix row. ");
+    }
+
+    VectorView<const T> x = v1;
+    if (!v1.contiguous())
+    {
+        T *staged = staging_buffer<T, 0>(v1.size());
+        copy(v1, VectorView<T>(staged, v1.size()));
+        x = VectorView<const T>(staged, v1.size());
+    }
+
+    /*column chunks are rounded to a cache line of elements*/
+    std::size_t grain = std::max(gemv_min_chunk / rows, cols / (4 * num_threads));
+    grain = std::max<std::size_t>((grain + 15) & ~std::size_t(15), 16);
+
+    parallel_for(0, cols, grain, [&](std::size_t col_start, std::size_t col_end)
+                 {
+                     int count = static_cast<int>(col_end - col_start);
+                     matrix_transpose_vector_multiply(m2.block(0, static_cast<int>(col_start), m2.getRows(), count), x,
+                                                      result.segment(static_cast<int>(col_start), count));
+                 });
+}
+
+/**
+ * Adds two vector views together, result = v1 + v2.
+ *
+ * @param v1 The first vector.
+ * @param v2 The second vector.
+ * @param result The resulting vector, may alias v1 or v2.
+ * @tparam X, Z, Y Element types of the views, equal up to const.
+ * @throws std::invalid_argument if the view sizes do not match.
+ */
+template <typename X, typename Z, typename Y>
+void vector_vector_add(VectorView<X> v1, VectorView<Z> v2, VectorView<Y> result)
+{
+    if (v1.size() != v2.size() || v1.size() != result.size())
+    {
+        throw std::invalid_argument("The number of vector rows must be equal in vector + error. ");
+    }
+
+    if (v1.contiguous() && v2.contiguous() && result.contiguous())
+    {
+        simd::vadd(v1.data(), v2.data(), result.data(), v1.size());
+        return;
+    }
+
+    for (int i = 0; i < v1.size(); i++)
+    {
+        result[i] = v1[i] + v2[i];
+    }
+}
+
+/**
+ * Adds two vector views together on the library thread pool.
+ * Vectors smaller than vadd_parallel_threshold are added on the calling thread.
+ *
+ * @param v1 The first vector.
+ * @param v2 The second vector.
+ * @param result The resulting vector.
+ * @param num_threads The maximum number of threads to use.
+ * @tparam X, Z, Y Element types of the views, equal up to const.
+ */
+template <typename X, typename Z, typename Y>
+void vector_vector_add(VectorView<X> v1, VectorView<Z> v2, VectorView<Y> result, int num_threads)
+{
+    std::size_t n = v1.size();
+
+    if (num_threads <= 1 || n < vadd_parallel_threshold)
+    {
+        vector_vector_add(v1, v2, result);
+        return;
+    }
+
+    if (v1.size() != v2.size() || v1.size() != result.size())
+    {
+        throw std::invalid_argument("The number of vector rows must be equal in vector + error. ");
+    }
+
+    std::size_t grain = std::max(vadd_min_chunk, n / (4 * num_threads));
+
+    parallel_for(0, n, grain, [&](std::size_t start, std::size_t end)
+                 {
+                     int first = static_cast<int>(start);
+                     int count = static_cast<int>(end - start);
+                     vector_vector_add(v1.segment(first, count), v2.segment(first, count), result.segment(first, count));
+                 });
+}
+
+/**
+ * Multiplies a matrix and a vector in a specified range of rows, one chunk of a parallel product.
+ * The rows are computed by the runtime dispatched simd::gemv kernel.
+ *
+ * @param m2 The matrix to multiply.
+ * @param v1 The vector to multiply.
+ * @param result The resulting vector.
+ * @param row_start The index of the first row to multiply.
+ * @param row_end The index of the last row to multiply.
+ * @tparam T The type of the elements in the matrix and vector.
+ */
+template <typename T>
+void matrix_vector_multiply_thread(const Matrix<T> &m2, const Vector<T> &v1,
+                                   Vector<T> &result, std::size_t row_start, std::size_t row_end)
+{
+    simd::gemv(static_cast<int>(row_end - row_start), m2.getCols(), m2[row_start], m2.getCols(),
+               v1.getdata(), result.getdata() + row_start);
+}
+
+/**
+ * Multiplies a matrix and a vector on the library thread pool.
+ * Products smaller than gemv_parallel_threshold run on the calling thread.
+ *
+ * @param m2 The matrix to multiply.
+ * @param v1 The vector to multiply.
+ * @param result The resulting vector.
+ * @param num_threads The maximum number of threads to use.
+ * @tparam T The type of the elements in the matrix and vector.
+ */
+template <typename T>
+void matrix_vector_multiply(const Matrix<T> &m2, const Vector<T> &v1, Vector<T> &result, std::size_t num_threads)
+{
+    matrix_vector_multiply(m2.view(), VectorView<const T>(v1), VectorView<T>(result), num_threads);
 }
 
 /**
@@ -86,19 +360,11 @@ void matrix_vector_multiply(const Matrix<T> &m2, const Vector<T> &v1, Vector<T>
 template <typename T>
 void matrix_vector_multiply(const Matrix<T> &m2, const Vector<T> &v1, Vector<T> &result)
 {
-    for (int k = 0; k < m2.getRows(); k++)
-    {
-        result[k] = 0;
-        for (int i = 0; i < v1.getRows(); i++)
-        {
-
-            result[k] += v1[i] * m2[k][i];
-        }
-    }
+    simd::gemv(m2.getRows(), m2.getCols(), m2.getdata(), m2.getCols(), v1.getdata(), result.getdata());
 }
 
 /**
- * Adds two vectors together in a specified range of indices using a single thread.
+ * Adds two vectors together in a specified range of indices, one chunk of a parallel sum.
  *
  * @param v1 The first vector.
  * @param v2 The second vector.
@@ -110,58 +376,23 @@ void matrix_vector_multiply(const Matrix<T> &m2, const Vector<T> &v1, Vector<T>
 template <typename T>
 void vector_addition_thread(const Vector<T> &v1, const Vector<T> &v2, Vector<T> &result, int start, int end)
 {
-    for (int i = start; i < end; i++)
-    {
-        result[i] = v1[i] + v2[i];
-    }
+    simd::vadd(v1.getdata() + start, v2.getdata() + start, result.getdata() + start, end - start);
 }
 
 /**
- * Adds two vectors together using a specified number of threads.
+ * Adds two vectors together on the library thread pool.
+ * Vectors smaller than vadd_parallel_threshold are added on the calling thread.
  *
  * @param v1 The first vector.
  * @param other The second vector.
  * @param result The resulting vector.
- * @param num_threads The number of threads to use.
+ * @param num_threads The maximum number of threads to use.
  * @tparam T The type of the elements in the vectors.
  */
 template <typename T>
 void vector_vector_add(const Vector<T> &v, const Vector<T> &other, Vector<T> &result, int num_threads)
 {
-
-    // Define the thread function for vector addition
-    auto vector_addition_thread = [](const Vector<T> &v1, const Vector<T> &v2, Vector<T> &result, int start, int end)
-    {
-        for (int i = start; i < end; i++)
-        {
-            result[i] = v1[i] + v2[i];
-        }
-    };
-
-    // Launch threads to perform vector addition in parallel
-    std::vector<boost::thread> threads;
-    int chunk_size = v.size() / num_threads;
-    int remainder = v.size() % num_threads;
-    int start = 0;
-    int end = 0;
-
-    for (int i = 0; i < num_threads; i++)
-    {
-        start = end;
-        end += chunk_size;
-        if (i == num_threads - 1)
-        {
-            end += remainder;
-        }
-        threads.emplace_back(vector_addition_thread, std::cref(v), std::cref(other),
-                             std::ref(result), start, end);
-    }
-
-    // Wait for all threads to finish
-    for (auto &thread : threads)
-    {
-        thread.join();
-    }
+    vector_vector_add(VectorView<const T>(v), VectorView<const T>(other), VectorView<T>(result), num_threads);
 }
 
 /**
@@ -175,8 +406,5 @@ void vector_vector_add(const Vector<T> &v, const Vector<T> &other, Vector<T> &re
 template <typename T>
 void vector_vector_add(const Vector<T> &v1, const Vector<T> &v2, Vector<T> &result)
 {
-    for (int i = 0; i < v1.size(); i++)
-    {
-        result[i] = v1[i] + v2[i];
-    }
+    simd::vadd(v1.getdata(), v2.getdata(), result.getdata(), v1.size());
 }
@@ -0,0 +1,124 @@
+/**
+ * @file random.h
+ * @brief Reproducible, thread-safe random numbers for initialization and shuffling.
+ *
+ *  \n Every generator is a counter-based Philox4x32-10 stream: the i-th number of a stream
+ *  \n is a pure function of (seed, stream, i). Streams hold no shared state, so concurrently
+ *  \n trained models and threads never contend, and a fill split over any number of threads
+ *  \n produces the same numbers as a serial one.
+ */
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*seed of the library streams unless one is given, e.g. by NeuralModel::initialize*/
+constexpr std::uint64_t default_seed = 2;
+
+/*below this many values a fill runs on the calling thread*/
+constexpr std::size_t random_parallel_threshold = 1 << 16;
+
+/**
+ * @brief How the weights of a dense layer with fan_in inputs and fan_out outputs are drawn.
+ *        \n The biases always start at zero.
+ */
+enum class Initializer
+{
+    uniform = 0,        /**< U(-1/sqrt(fan_in), 1/sqrt(fan_in)) */
+    normal = 1,         /**< N(0, 1/fan_in) */
+    xavier_uniform = 2, /**< U(-a, a) with a = sqrt(6/(fan_in + fan_out)), for sigmoid, tanh and linear layers */
+    xavier_normal = 3,  /**< N(0, 2/(fan_in + fan_out)) */
+    he_uniform = 4,     /**< U(-a, a) with a = sqrt(6/fan_in), for relu-like layers */
+    he_normal = 5       /**< N(0, 2/fan_in) */
+};
+
+/**
+ * @brief One independent stream of random numbers.
+ *        \n Each float takes one 32-bit word of the stream and each double two, so a
+ *        \n fill of n values advances the stream by n or 2n words.
+ */
+class RandomStream
+{
+public:
+    /**
+     * @brief Constructs the stream with the given id under a seed.
+     *
+     * @param seed Selects the family of streams, e.g. one per experiment.
+     * @param stream Selects one stream of the family, e.g. one per model, layer or thread.
+     */
+    explicit RandomStream(std::uint64_t seed = default_seed, std::uint64_t stream = 0)
+        : seed_(seed), stream_(stream)
+    {
+    }
+
+    /**
+     * @brief Returns an independent stream derived from this one, e.g. for a worker thread.
+     *        \n The result depends only on the seed, the stream id and id.
+     */
+    RandomStream split(std::uint64_t id) const;
+
+    /**
+     * @brief Position of the stream in 32-bit words.
+     */
+    std::uint64_t position() const { return position_; }
+
+    /**
+     * @brief Moves the stream to a position in 32-bit words.
+     */
+    void seek(std::uint64_t position) { position_ = position; }
+
+    /**
+     * @brief Next raw 32-bit word.
+     */
+    std::uint32_t next();
+
+    /**
+     * @brief Next n raw 32-bit words, e.g. for a shuffle.
+     */
+    void next(std::uint32_t *out, std::size_t n);
+
+    /**
+     * @brief Next double in [0, 1), with 53 random bits.
+     */
+    double uniform();
+
+    /**
+     * @brief Next integer in [0, n), n must be positive.
+     */
+    int below(int n);
+
+    /**
+     * @brief Fills out with n values uniform in [lo, hi).
+     *        \n Large fills are split over the thread pool when PARALLEL is enabled.
+     */
+    void uniform(float *out, std::size_t n, float lo = 0, float hi = 1);
+    void uniform(double *out, std::size_t n, double lo = 0, double hi = 1);
+
+    /**
+     * @brief Fills out with n normally distributed values (Box-Muller on pairs of uniforms).
+     *        \n Large fills are split over the thread pool when PARALLEL is enabled.
+     */
+    void normal(float *out, std::size_t n, float mean = 0, float stddev = 1);
+    void normal(double *out, std::size_t n, double mean = 0, double stddev = 1);
+
+private:
+    std::uint64_t seed_;
+    std::uint64_t stream_;
+    std::uint64_t position_ = 0;
+};
+
+/**
+ * @brief Fills the weights of a dense layer, stored fan_out x fan_in.
+ *
+ * @param weights The fan_out * fan_in weights.
+ * @param fan_in Number of inputs of the layer.
+ * @param fan_out Number of outputs of the layer.
+ * @param kind The distribution to draw from.
+ * @param stream The stream the values are taken from.
+ */
+void initialize_weights(float *weights, int fan_in, int fan_out, Initializer kind, RandomStream &stream);
+void initialize_weights(double *weights, int fan_in, int fan_out, Initializer kind, RandomStream &stream);
+
+#endif // RANDOM_H
@@ -0,0 +1,149 @@
+/**
+ * @file sampler.h
+ * @brief Per-epoch row orders for training, as index lists into data that is never moved.
+ *
+ *  \n A RowSampler hands out a fresh list of row indices every epoch, to be fed to
+ *  \n NeuralModel::train_subset or SimpleNeuralNetwork::setSampler. The order of epoch e
+ *  \n is a pure function of the seed and e, so a run can be reproduced or resumed.
+ */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Matrix.hpp"
+#include "random.h"
+
+using namespace phoenix;
+
+/**
+ * @brief How a RowSampler orders the rows of an epoch.
+ */
+enum class Sampling
+{
+    sequential = 0, /**< Rows 0 .. rows - 1 in order, every epoch */
+    shuffle = 1,    /**< A uniform random permutation (Fisher-Yates) */
+    stratified = 2, /**< A random permutation that spreads every class evenly over the epoch */
+    weighted = 3    /**< Rows drawn with replacement with probability proportional to a weight */
+};
+
+/**
+ * @brief Shuffles the indices uniformly in place (Fisher-Yates).
+ *
+ * @param indices The indices to permute.
+ * @param stream The stream the swaps are drawn from.
+ */
+void shuffle_indices(std::vector<int> &indices, RandomStream &stream);
+
+/**
+ * @brief Row orders of successive epochs over a data set.
+ *        \n The index list is rebuilt in place, only the constructor allocates per row.
+ */
+class RowSampler
+{
+public:
+    /**
+     * @brief Constructs a sequential or shuffling sampler.
+     *
+     * @param rows Number of rows of the data.
+     * @param kind Sampling::sequential or Sampling::shuffle.
+     * @param seed Seed of the permutations.
+     * @throws std::invalid_argument if rows is negative or kind needs labels or weights.
+     */
+    explicit RowSampler(int rows, Sampling kind = Sampling::shuffle, std::uint64_t seed = default_seed);
+
+    /**
+     * @brief Constructs a stratified sampler: each epoch is a random permutation in which the
+     *        \n rows of every class are spread evenly, so any window of the order, e.g. a
+     *        \n mini-batch, holds the classes close to their overall proportions.
+     *
+     * @param labels The class of each row, e.g. from class_labels.
+     * @param seed Seed of the permutations.
+     */
+    explicit RowSampler(const std::vector<int> &labels, std::uint64_t seed = default_seed);
+
+    /**
+     * @brief Constructs a weighted sampler: each epoch draws rows with replacement, row i with
+     *        \n probability weights[i] / sum(weights), in O(1) per draw (alias method).
+     *
+     * @param weights A non-negative weight per row, e.g. to balance rare classes.
+     * @param draws Rows per epoch, the number of rows if zero or negative.
+     * @param seed Seed of the draws.
+     * @throws std::invalid_argument if a weight is negative or not finite, or all are zero.
+     */
+    explicit RowSampler(const std::vector<double> &weights, int draws = 0, std::uint64_t seed = default_seed);
+
+    /**
+     * @brief Row order of epoch e, valid until the next call.
+     */
+    const std::vector<int> &epoch(std::uint64_t e);
+
+    /**
+     * @brief Row order of the epoch after the one last returned by next, starting at epoch 0.
+     */
+    const std::vector<int> &next() { return epoch(current++); }
+
+    /**
+     * @brief Moves next() to epoch e, e.g. when training resumes.
+     */
+    void seek(std::uint64_t e) { current = e; }
+
+    /**
+     * @brief Number of indices in each epoch.
+     */
+    int size() const { return static_cast<int>(order.size()); }
+
+    /**
+     * @brief How the rows are ordered.
+     */
+    Sampling kind() const { return sampling; }
+
+private:
+    Sampling sampling;
+    std::uint64_t seed;
+    std::uint64_t current = 0;
+    std::vector<int> order;
+
+    /*stratified: rows of each class, and the sort keys of an epoch*/
+    std::vector<std::vector<int>> classes;
+    std::vector<std::pair<double, int>> keys;
+
+    /*weighted: acceptance probability and alias of each row*/
+    std::vector<double> probability;
+    std::vector<int> alias;
+};
+
+/**
+ * @brief Class of each row of a target matrix: the column of the largest value for one-hot
+ *        \n rows, the value rounded to an integer for a single column.
+ *
+ * @param Y The target matrix, one sample per row.
+ * @return One label per row.
+ */
+template <typename T>
+std::vector<int> class_labels(const Matrix<T> &Y)
+{
+    std::vector<int> labels(Y.getRows());
+    for (int i = 0; i < Y.getRows(); i++)
+    {
+        const T *row = Y[i];
+        if (Y.getCols() == 1)
+        {
+            labels[i] = static_cast<int>(std::lround(row[0]));
+            continue;
+        }
+        int best = 0;
+        for (int j = 1; j < Y.getCols(); j++)
+        {
+            if (row[j] > row[best])
+                best = j;
+        }
+        labels[i] = best;
+    }
+    return labels;
+}
+
+#endif // SAMPLER_H
@@ -0,0 +1,294 @@
+/**
+ * @file simd.h
+ * @brief Runtime dispatched SIMD kernels for the dense vector operations of the library.
+ *
+ *  \n Every kernel is compiled once per instruction set (scalar, SSE2, AVX2/FMA and AVX-512)
+ *  \n and the best variant supported by the host is picked from CPUID the first time a
+ *  \n kernel is called, so a single binary runs at full width on every CPU generation.
+ *  \n The choice can be forced with the PHOENIX_SIMD environment variable
+ *  \n (scalar, sse2, avx2 or avx512); requests above what the host supports are ignored.
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace phoenix {
+namespace simd {
+
+/**
+ * @brief Instruction sets a kernel can be dispatched to.
+ */
+enum class isa
+{
+    scalar,
+    sse2,
+    avx2,
+    avx512
+};
+
+/**
+ * @brief Returns the instruction set the kernels are dispatched to on this host.
+ */
+isa active_isa();
+
+/**
+ * @brief Returns a printable name for an instruction set.
+ */
+const char *isa_name(isa set);
+
+/**
+ * @brief Dense matrix vector product, y = A * x.
+ *
+ * @param rows Number of rows of A (and elements of y).
+ * @param cols Number of columns of A (and elements of x).
+ * @param a Pointer to the first row of A, rows are contiguous.
+ * @param lda Distance in elements between two consecutive rows of A.
+ * @param x Input vector.
+ * @param y Output vector, overwritten.
+ */
+void gemv(int rows, int cols, const double *a, std::ptrdiff_t lda, const double *x, double *y);
+void gemv(int rows, int cols, const float *a, std::ptrdiff_t lda, const float *x, float *y);
+
+/**
+ * @brief Dense transposed matrix vector product, y = A^T * x, without transposing A.
+ *        \n A is swept row by row as y += x[k] * A[k], four rows per pass over a block
+ *        \n of y that stays in L1, so every load of A has unit stride.
+ *
+ * @param rows Number of rows of A (and elements of x).
+ * @param cols Number of columns of A (and elements of y).
+ * @param a Pointer to the first row of A, rows are contiguous.
+ * @param lda Distance in elements between two consecutive rows of A.
+ * @param x Input vector.
+ * @param y Output vector, overwritten.
+ */
+void gemv_transposed(int rows, int cols, const double *a, std::ptrdiff_t lda, const double *x, double *y);
+void gemv_transposed(int rows, int cols, const float *a, std::ptrdiff_t lda, const float *x, float *y);
+
+/**
+ * @brief Shape of the register tile computed by gemm_tile, used as MR x NR by gemm.h.
+ */
+template <typename T>
+struct tile_shape
+{
+    static constexpr int rows = 4;
+    static constexpr int cols = 4;
+};
+
+template <>
+struct tile_shape<double>
+{
+    static constexpr int rows = 4;
+    static constexpr int cols = 8;
+};
+
+template <>
+struct tile_shape<float>
+{
+    static constexpr int rows = 8;
+    static constexpr int cols = 8;
+};
+
+/**
+ * @brief Micro-kernel of the blocked GEMM, C[mr x nr] += A_sliver * B_sliver.
+ *        \n The slivers are packed by gemm.h: kc groups of tile_shape<T>::rows elements of A
+ *        \n and kc groups of tile_shape<T>::cols elements of B. The whole tile is accumulated
+ *        \n in vector registers and C is read and written once. AVX-512 hosts use the AVX2 kernel.
+ *
+ * @param kc Depth of the packed slivers.
+ * @param a Packed A sliver.
+ * @param b Packed B sliver.
+ * @param c Pointer to the top left element of the C tile.
+ * @param rsc Row stride of C.
+ * @param csc Column stride of C.
+ * @param mr Number of valid rows in the tile.
+ * @param nr Number of valid columns in the tile.
+ */
+void gemm_tile(int kc, const double *a, const double *b, double *c, std::ptrdiff_t rsc, std::ptrdiff_t csc, int mr, int nr);
+void gemm_tile(int kc, const float *a, const float *b, float *c, std::ptrdiff_t rsc, std::ptrdiff_t csc, int mr, int nr);
+
+/**
+ * @brief Fused momentum update of n parameters in one pass,
+ *        \n v = mu * v - rate * g, then p += a * v + c * g.
+ *        \n a = 1, c = 0 gives classical momentum and a = mu, c = -rate Nesterov momentum.
+ *        \n AVX-512 hosts use the AVX2 kernel.
+ *
+ * @param n Number of parameters.
+ * @param p Parameters, updated in place.
+ * @param g Gradient of the loss.
+ * @param v Velocity, updated in place.
+ */
+void momentum_step(int n, double *p, const double *g, double *v, double mu, double rate, double a, double c);
+void momentum_step(int n, float *p, const float *g, float *v, float mu, float rate, float a, float c);
+
+/**
+ * @brief Fused adaptive update of n parameters in one pass,
+ *        \n m = b1 * m + (1 - b1) * g, v = b2 * v + (1 - b2) * g^2, p -= rate * m / (sqrt(v) + eps).
+ *        \n With m == nullptr the gradient is used in place of m (RMSProp).
+ *        \n AVX-512 hosts use the AVX2 kernel.
+ *
+ * @param n Number of parameters.
+ * @param p Parameters, updated in place.
+ * @param g Gradient of the loss.
+ * @param m First moment, updated in place, or nullptr.
+ * @param v Second moment, updated in place.
+ */
+void adaptive_step(int n, double *p, const double *g, double *m, double *v, double b1, double b2, double rate, double eps);
+void adaptive_step(int n, float *p, const float *g, float *m, float *v, float b1, float b2, float rate, float eps);
+
+/**
+ * @brief Accuracy of vexp, vsigmoid and vtanh.
+ *        \n exact calls the C library for every element. high and fast evaluate a range
+ *        \n reduced polynomial over whole registers, with a relative error near 1e-8 (float
+ *        \n rounding, about 1e-7, dominates in single precision) and near 1e-3 respectively.
+ */
+enum class accuracy
+{
+    exact,
+    high,
+    fast
+};
+
+/**
+ * @brief Element-wise exponential, y = exp(x). AVX-512 hosts use the AVX2 kernel.
+ *        \n The approximations clamp x to the range where the result is a normal number.
+ *
+ * @param n Number of elements.
+ * @param x Input vector.
+ * @param y Output vector, may alias x.
+ * @param acc Accuracy of the result.
+ */
+void vexp(int n, const double *x, double *y, accuracy acc);
+void vexp(int n, const float *x, float *y, accuracy acc);
+
+/**
+ * @brief Element-wise logistic function, y = 1 / (1 + exp(-x)), see vexp.
+ */
+void vsigmoid(int n, const double *x, double *y, accuracy acc);
+void vsigmoid(int n, const float *x, float *y, accuracy acc);
+
+/**
+ * @brief Element-wise hyperbolic tangent, y = tanh(x), see vexp.
+ *        \n Near zero the approximation works on exp(2|x|) - 1 directly, so the relative
+ *        \n error does not grow for small arguments.
+ */
+void vtanh(int n, const double *x, double *y, accuracy acc);
+void vtanh(int n, const float *x, float *y, accuracy acc);
+
+/**
+ * @brief Inner product of two contiguous vectors.
+ *
+ * @param a First vector.
+ * @param b Second vector.
+ * @param n Number of elements.
+ * @return The sum of a[i] * b[i].
+ */
+double dot(const double *a, const double *b, int n);
+float dot(const float *a, const float *b, int n);
+
+/**
+ * @brief Dense int8 matrix vector product with int32 accumulation, y = A * x.
+ *        \n Used by quantized inference; products are summed exactly, so the result
+ *        \n does not depend on the instruction set. AVX-512 hosts use the AVX2 kernel.
+ *
+ * @param rows Number of rows of A (and elements of y).
+ * @param cols Number of columns of A (and elements of x).
+ * @param a Pointer to the first row of A, rows are contiguous.
+ * @param lda Distance in elements between two consecutive rows of A.
+ * @param x Input vector.
+ * @param y Output vector, overwritten.
+ */
+void gemv(int rows, int cols, const std::int8_t *a, std::ptrdiff_t lda, const std::int8_t *x, std::int32_t *y);
+
+/**
+ * @brief Philox4x32-10 counter-based random blocks, four 32-bit words per counter.
+ *        \n Block b is a pure function of (counter + b, stream, key), so any range of a stream
+ *        \n can be generated independently; the words do not depend on the instruction set.
+ *
+ * @param counter Counter of the first block.
+ * @param stream Upper 64 bits of the counter, selects an independent stream.
+ * @param key The key, usually the seed.
+ * @param blocks Number of consecutive blocks to generate.
+ * @param out Output array of 4 * blocks words.
+ */
+void philox(std::uint64_t counter, std::uint64_t stream, std::uint64_t key, int blocks, std::uint32_t *out);
+
+/**
+ * @brief Element-wise sum of two contiguous vectors, out = a + b.
+ *
+ * @param a First vector.
+ * @param b Second vector.
+ * @param out Output vector, may alias a or b.
+ * @param n Number of elements.
+ */
+void vadd(const double *a, const double *b, double *out, int n);
+void vadd(const float *a, const float *b, float *out, int n);
+
+/**
+ * @brief Generic fallback of gemv for element types without a SIMD kernel.
+ */
+template <typename T>
+void gemv(int rows, int cols, const T *a, std::ptrdiff_t lda, const T *x, T *y)
+{
+    for (int k = 0; k < rows; k++)
+    {
+        T sum = 0;
+        for (int i = 0; i < cols; i++)
+        {
+            sum += a[k * lda + i] * x[i];
+        }
+        y[k] = sum;
+    }
+}
+
+/**
+ * @brief Generic fallback of gemv_transposed for element types without a SIMD kernel.
+ */
+template <typename T>
+void gemv_transposed(int rows, int cols, const T *a, std::ptrdiff_t lda, const T *x, T *y)
+{
+    for (int i = 0; i < cols; i++)
+    {
+        y[i] = 0;
+    }
+    for (int k = 0; k < rows; k++)
+    {
+        for (int i = 0; i < cols; i++)
+        {
+            y[i] += a[k * lda + i] * x[k];
+        }
+    }
+}
+
+/**
+ * @brief Generic fallback of dot for element types without a SIMD kernel.
+ */
+template <typename T>
+T dot(const T *a, const T *b, int n)
+{
+    T sum = 0;
+    for (int i = 0; i < n; i++)
+    {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief Generic fallback of vadd for element types without a SIMD kernel.
+ */
+template <typename T>
+void vadd(const T *a, const T *b, T *out, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        out[i] = a[i] + b[i];
+    }
+}
+
+}
+}
+
+#endif // SIMD_H
@@ -0,0 +1,125 @@
+/**
+ * @file threadpool.h
+ * @brief Library wide pool of persistent worker threads.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace phoenix {
+
+/**
+ * @brief A fixed set of worker threads that execute parallel_for loops.
+ *        \n The workers are started once and sleep between jobs, so handing a loop to the
+ *        \n pool costs a wake up instead of a thread creation. The calling thread always
+ *        \n takes part in its own loop, and a parallel_for issued from inside a running
+ *        \n loop body executes inline on the current thread.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @brief Returns the pool shared by the whole library.
+     *        \n It has hardware_concurrency() - 1 workers unless PHOENIX_NUM_THREADS is set.
+     */
+    static ThreadPool &instance();
+
+    /**
+     * @brief Starts a pool with the given number of worker threads.
+     *
+     * @param workers Number of threads to start in addition to the caller.
+     */
+    explicit ThreadPool(std::size_t workers);
+
+    /**
+     * @brief Stops and joins all worker threads.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief Number of threads that can work on a loop, workers plus the caller.
+     */
+    std::size_t size() const { return workers_.size() + 1; }
+
+    /**
+     * @brief Runs body over [begin, end) split into chunks of grain iterations.
+     *
+     * @param begin First index of the range.
+     * @param end One past the last index of the range.
+     * @param grain Number of iterations handed out at once, the smallest unit of work.
+     * @param body Callable invoked as body(chunk_begin, chunk_end).
+     * @throws Rethrows the first exception thrown by body once every chunk has finished.
+     */
+    template <typename F>
+    void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, F &&body)
+    {
+        using Body = std::remove_reference_t<F>;
+        Task task{const_cast<void *>(static_cast<const void *>(&body)),
+                  [](void *ctx, std::size_t first, std::size_t last)
+                  { (*static_cast<Body *>(ctx))(first, last); }};
+        run(begin, end, grain, task);
+    }
+
+private:
+    /*non-owning reference to a loop body, avoids a std::function allocation per loop*/
+    struct Task
+    {
+        void *ctx;
+        void (*invoke)(void *, std::size_t, std::size_t);
+    };
+
+    struct Job
+    {
+        Task body;
+        std::size_t begin;
+        std::size_t end;
+        std::size_t grain;
+        std::size_t chunks;
+        std::atomic<std::size_t> next{0};
+        std::size_t active = 0;
+        std::exception_ptr error;
+    };
+
+    void run(std::size_t begin, std::size_t end, std::size_t grain, Task body);
+    void worker_loop();
+    void run_chunks(Job &job);
+    void retire(Job *job);
+
+    std::vector<std::thread> workers_;
+    std::vector<Job *> jobs_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    bool stop_ = false;
+};
+
+/**
+ * @brief Runs body over [begin, end) on the library thread pool.
+ *
+ * @param begin First index of the range.
+ * @param end One past the last index of the range.
+ * @param grain Number of iterations handed out at once.
+ * @param body Callable invoked as body(chunk_begin, chunk_end).
+ */
+template <typename F>
+void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, F &&body)
+{
+    ThreadPool::instance().parallel_for(begin, end, grain, std::forward<F>(body));
+}
+
+}
+
+#endif // THREADPOOL_H
@@ -8,6 +8,7 @@
 
 #include "Vector.hpp"
 #include <algorithm>
+#include <limits>
 #include <memory>
 #include <random>
 #include <initializer_list>
@@ -25,7 +26,7 @@ double sum(Matrix<T> X) {   return X.Tsum(); }
 
 /**
 
-    @brief Computes the total error between a target vector and an output vector.
+    @brief Computes the total error between a target view and an output view.
     The total error is computed as the sum of the root mean squared error (RMSE) between each
     corresponding element in the target and output vectors.
     @tparam T The data type of the input vectors (e.g. float, double, int).
@@ -35,7 +36,7 @@ double sum(Matrix<T> X) {   return X.Tsum(); }
     @throw std::invalid_argument If the number of rows in the target and output vectors is not equal.
     */
 template <typename T>
-T total_error(const Vector<T> target, const Vector<T> output)
+T total_error(VectorView<const T> target, VectorView<const T> output)
 {
     if (output.getRows() != target.getRows())
     {
@@ -51,6 +52,116 @@ T total_error(const Vector<T> target, const Vector<T> output)
     return sum;
 }
 
+/**
+
+    @brief Computes the total error between a target vector and an output vector.
+    @tparam T The data type of the input vectors (e.g. float, double, int).
+    @param target The target vector with the desired values.
+    @param output The output vector with the predicted values.
+    @return The total error between the target and output vectors.
+    @throw std::invalid_argument If the number of rows in the target and output vectors is not equal.
+    */
+template <typename T>
+T total_error(const Vector<T> &target, const Vector<T> &output)
+{
+    return total_error(VectorView<const T>(target), VectorView<const T>(output));
+}
+
+/**
+
+    @brief Computes the cross-entropy between a target distribution and a predicted one.
+    The cross-entropy is -sum(target[i] * log(output[i])); output is clamped away from zero
+    so that a saturated prediction gives a large but finite loss.
+    @tparam T The data type of the input vectors (float or double).
+    @param target The target distribution, e.g. a one-hot row.
+    @param output The predicted probabilities, e.g. the softmax output.
+    @return The cross-entropy of the output with respect to the target.
+    @throw std::invalid_argument If the number of rows in the target and output vectors is not equal.
+    */
+template <typename T>
+T cross_entropy(VectorView<const T> target, VectorView<const T> output)
+{
+    if (output.getRows() != target.getRows())
+    {
+        throw std::invalid_argument("The number of vector rows must be equal in cross entropy compute. ");
+    }
+
+    T sum = 0.0;
+
+    for (int i = 0; i < target.getRows(); i++)
+    {
+        if (target[i] != T(0))
+            sum -= target[i] * std::log(std::max(output[i], std::numeric_limits<T>::min()));
+    }
+    return sum;
+}
+
+/**
+
+    @brief Returns the index of the largest element of a view, the first one on ties.
+    @tparam T The data type of the vector.
+    @param v The vector to search, it must not be empty.
+    @return The position of the maximum element.
+    */
+template <typename T>
+int argmax(VectorView<const T> v)
+{
+    int position = 0;
+    for (int i = 1; i < v.size(); i++)
+    {
+        if (v[i] > v[position])
+            position = i;
+    }
+    return position;
+}
+
+/**
+
+    @brief Writes the index of the largest element of every row of a batch.
+    @tparam T The data type of the matrix.
+    @param m The batch, one sample per row.
+    @param index Output array with one entry per row of m.
+    */
+template <typename T>
+void argmax_rows(MatrixView<const T> m, int *index)
+{
+    for (int r = 0; r < m.getRows(); r++)
+    {
+        index[r] = argmax(m.row(r));
+    }
+}
+
+/**
+
+    @brief Computes the classification accuracy of a batch of predictions.
+    A row counts as correct when its largest prediction is at the position of the largest
+    expected value, e.g. the one in a one-hot label row.
+    @tparam T The data type of the matrices.
+    @param predicted The predicted scores or probabilities, one sample per row.
+    @param expected The expected outputs, one sample per row.
+    @return The fraction of correctly classified rows, 0 for an empty batch.
+    @throw std::invalid_argument If the two batches differ in shape.
+    */
+template <typename T>
+double accuracy(MatrixView<const T> predicted, MatrixView<const T> expected)
+{
+    if (predicted.getRows() != expected.getRows() || predicted.getCols() != expected.getCols())
+    {
+        throw std::invalid_argument("The predicted and expected batches must have the same shape. ");
+    }
+
+    if (predicted.getRows() == 0)
+        return 0;
+
+    int correct = 0;
+    for (int r = 0; r < predicted.getRows(); r++)
+    {
+        if (argmax(predicted.row(r)) == argmax(expected.row(r)))
+            correct++;
+    }
+    return static_cast<double>(correct) / predicted.getRows();
+}
+
 /**
 
     @brief Converts a row of a matrix into a vector.
@@ -60,15 +171,13 @@ T total_error(const Vector<T> target, const Vector<T> output)
     @param other The matrix from which to extract the row.
     @param i The index of the row to extract.
     @return A vector containing the elements of the specified row.
+    @note Use Matrix::row for a view on the row that does not copy it.
 */
 template <typename T>
 Vector<T> convert_row(Matrix<T> &other, int i)
 {
     Vector<T> result(other.getCols());
-    for (int j = 0; j < other.getCols(); j++)
-    {
-        result[j] = other(i, j);
-    }
+    copy(other.row(i), VectorView<T>(result));
 
     return result;
 }
@@ -82,15 +191,13 @@ Vector<T> convert_row(Matrix<T> &other, int i)
     @param other The matrix from which to extract the column.
     @param j The index of the column to extract.
     @return A vector containing the elements of the specified column.
+    @note Use Matrix::col for a view on the column that does not copy it.
  */
 template <typename T>
 Vector<T> convert_col(Matrix<T> &other, int j)
 {
     Vector<T> result(other.getRows());
-    for (int i = 0; i < other.getRows(); i++)
-    {
-        result[i] = other(i, j);
-    }
+    copy(other.col(j), VectorView<T>(result));
 
     return result;
 }
@@ -135,16 +242,8 @@ Vector<T> vecTomat_multiply(Vector<T> &v1, Matrix<T> &m2)
     {
         throw std::invalid_argument("The number of vector rows must be equal to Matrix column. ");
     }
-    Vector<double> result(m2.getRows());
-    for (int k = 0; k < m2.getRows(); k++)
-    {
-        result[k] = 0;
-
-        for (int i = 0; i < v1.getRows(); i++)
-        {
-            result[k] += v1[i] * m2[k][i];
-        }
-    }
+    Vector<T> result(m2.getRows());
+    matrix_vector_multiply(m2, v1, result);
 
     return result;
 }
@@ -181,7 +280,7 @@ Vector<T> vector_sigmoid(Vector<T> &v)
     @return A vector containing the result of applying the activation function to the input vector.
     */
 template <typename T>
-Vector<T> vector_act(Vector<T> &v, std::function<double(double)> &act)
+Vector<T> vector_act(Vector<T> &v, std::function<T(T)> &act)
 {
     Vector<T> result(v.size());
 
@@ -221,18 +320,20 @@ Vector<T> v_sigmoid_derivative(Vector<T> &v)
     @tparam T the type of elements in the matrix.
     @param matrix the matrix to shuffle.
     @param randomness the probability of shuffling each row.
+    @param seed seed of the shuffle, the same seed always gives the same order.
+    @note The rows are moved in memory. To reshuffle every epoch without touching the data,
+    train on the index lists of a RowSampler (sampler.h) instead.
     */
 template <typename T>
-void ShuffleMatrixRows(Matrix<T> &matrix, double randomness)
+void ShuffleMatrixRows(Matrix<T> &matrix, double randomness, std::uint64_t seed = default_seed)
 {
-    std::mt19937 rng(std::random_device{}());
-    std::uniform_real_distribution<double> dist(0, 1);
+    RandomStream rng(seed);
 
     for (int i = 0; i < matrix.getRows(); ++i)
     {
-        if (dist(rng) <= randomness)
+        if (rng.uniform() <= randomness)
         {
-            int j = i + std::uniform_int_distribution<int>(0, matrix.getRows() - i - 1)(rng);
+            int j = i + rng.below(matrix.getRows() - i);
             std::swap_ranges(matrix.getdata()  + i * matrix.getCols(),
                              matrix.getdata()  + (i + 1) * matrix.getCols(),
                              matrix.getdata()  + j * matrix.getCols());
@@ -257,15 +358,9 @@ Matrix<T> SetMatrix(Matrix<T> &matrix, std::initializer_list<std::string> labels
     Matrix<T> result(rows, cols);
 
     int j = 0;
-    for (std::string n : labels)
+    for (const std::string &n : labels)
     {
-        auto recept = convert_col(matrix, stoi(n));
-
-        for (int i = 0; i < rows; i++)
-        {
-            result(i, j) = recept[i];
-        }
-        ++j;
+        copy(matrix.col(stoi(n)), result.col(j++));
     }
 
     return result;
@@ -290,13 +385,7 @@ Matrix<T> SetMatrix(Matrix<T> &matrix, std::vector<int> labels)
     int j = 0;
     for (int n : labels)
     {
-        auto recept = convert_col(matrix, n);
-
-        for (int i = 0; i < rows; i++)
-        {
-            result(i, j) = recept[i];
-        }
-        ++j;
+        copy(matrix.col(n), result.col(j++));
     }
 
     return result;
@@ -316,22 +405,18 @@ Matrix<T> RowMatrix(Matrix<T> &matrix, int nrows)
     int start = nrows > 0 ? 0 : abs(nrows);         // 0 (start) or 75(start)
     int end = nrows > 0 ? nrows : matrix.getRows(); // 35(end) or rows(end)
 
+    if (end > matrix.getRows() || start > matrix.getRows())
+    {
+        throw std::invalid_argument("The number of rows to extract exceeds the matrix rows. ");
+    }
+
     int rows = end - start;
     int cols = matrix.getCols();
 
     Matrix<T> result(rows, cols);
 
-    int j = 0;
-    for (int il = start; il < end; il++)
-    {
-        auto recept = convert_row(matrix, il);
-
-        for (int i = 0; i < cols; i++)
-        {
-            result(j, i) = recept[i];
-        }
-        ++j;
-    }
+    /*the selected rows are one contiguous run of the row-major buffer*/
+    std::copy(matrix[start], matrix[start] + static_cast<std::size_t>(rows) * cols, result.getdata());
 
     return result;
 }
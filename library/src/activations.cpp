@@ -1,5 +1,11 @@
 #include "activations.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
 /**
 
     @brief Computes the sigmoid function of a given value.
@@ -23,10 +29,9 @@ double sigmoid(double x){
     @return The value of the derivative of the sigmoid function at the input point.
 */
 double sigmoid_derivative(double a){
-        double result;
-        result = sigmoid(a) * (1.0 - sigmoid(a));
+        double s = sigmoid(a);
 
-        return result;
+        return s * (1.0 - s);
     }  
 
 /**
@@ -79,6 +84,228 @@ double linear(double x){
 double linear_derivative(double a){
 
         return 1;
-    }  
+    }
+
+/**
+
+    @brief Single precision sigmoid, see sigmoid(double).
+*/
+float sigmoid(float x){
+
+        return 1.0f/(1.0f + std::exp(-x));
+    }
+
+/**
+
+    @brief Single precision sigmoid derivative, see sigmoid_derivative(double).
+*/
+float sigmoid_derivative(float a){
+        float s = sigmoid(a);
+
+        return s * (1.0f - s);
+    }
+
+/**
+
+    @brief Single precision ReLU, see relu(double).
+*/
+float relu(float x){
+
+        return std::max(0.0f, x);
+    }
+
+/**
+
+    @brief Single precision ReLU derivative, see relu_derivative(double).
+*/
+float relu_derivative(float a){
+
+        return ( a > 0.0f) ? 1.0f : 0.0f;
+    }
+
+/**
+
+    @brief Single precision linear function, see linear(double).
+*/
+float linear(float x){
+
+        return x;
+    }
+
+/**
+
+    @brief Single precision linear derivative, see linear_derivative(double).
+*/
+float linear_derivative(float /*a*/){
+
+        return 1.0f;
+    }
+
+namespace {
+
+phoenix::simd::accuracy accuracy_from_environment()
+{
+    const char *env = std::getenv("PHOENIX_ACCURACY");
+    if (env != nullptr && std::strcmp(env, "high") == 0)
+        return phoenix::simd::accuracy::high;
+    if (env != nullptr && std::strcmp(env, "fast") == 0)
+        return phoenix::simd::accuracy::fast;
+    return phoenix::simd::accuracy::exact;
+}
+
+std::atomic<phoenix::simd::accuracy> &accuracy_setting()
+{
+    static std::atomic<phoenix::simd::accuracy> acc{accuracy_from_environment()};
+    return acc;
+}
+
+/*slope of leaky ReLU for negative inputs*/
+constexpr double leaky_slope = 0.01;
+
+template <typename T>
+struct sigmoid_fn
+{
+    static void span(int n, const T *z, T *y) { phoenix::simd::vsigmoid(n, z, y, activation_accuracy()); }
+    static T df(T, T y) { return y * (T(1) - y); }
+};
+
+template <typename T>
+struct relu_fn
+{
+    static T f(T z) { return z > T(0) ? z : T(0); }
+    static T df(T, T y) { return y > T(0) ? T(1) : T(0); }
+};
+
+template <typename T>
+struct linear_fn
+{
+    static T f(T z) { return z; }
+    static T df(T, T) { return T(1); }
+};
+
+template <typename T>
+struct tanh_fn
+{
+    static void span(int n, const T *z, T *y) { phoenix::simd::vtanh(n, z, y, activation_accuracy()); }
+    static T df(T, T y) { return T(1) - y * y; }
+};
+
+template <typename T>
+struct leaky_relu_fn
+{
+    static T f(T z) { return z > T(0) ? z : static_cast<T>(leaky_slope) * z; }
+    static T df(T z, T) { return z > T(0) ? T(1) : static_cast<T>(leaky_slope); }
+};
+
+/*exact GELU, z * Phi(z) with Phi the standard normal distribution function*/
+template <typename T>
+struct gelu_fn
+{
+    static T f(T z) { return T(0.5) * z * (T(1) + std::erf(z * T(0.70710678118654752440))); }
+
+    /*Phi(z) + z * phi(z), Phi is read back from y = z * Phi(z) away from zero*/
+    static T df(T z, T y)
+    {
+        T cdf = std::fabs(z) > T(1e-3) ? y / z : T(0.5) + T(0.39894228040143267794) * z;
+        T pdf = T(0.39894228040143267794) * std::exp(T(-0.5) * z * z);
+        return cdf + z * pdf;
+    }
+};
+
+/*numerically stable softmax, exp(z - max z) normalized over the span*/
+template <typename T>
+struct softmax_fn
+{
+    static void span(int n, const T *z, T *y)
+    {
+        if (n <= 0)
+            return;
+
+        T top = z[0];
+        for (int i = 1; i < n; i++)
+            top = std::max(top, z[i]);
+        for (int i = 0; i < n; i++)
+            y[i] = z[i] - top;
+
+        phoenix::simd::vexp(n, y, y, activation_accuracy());
+
+        T sum = 0;
+        for (int i = 0; i < n; i++)
+            sum += y[i];
+        T inv = T(1) / sum;
+        for (int i = 0; i < n; i++)
+            y[i] *= inv;
+    }
+
+    /*the cross-entropy error expected - p is already the gradient with respect to z*/
+    static T df(T, T) { return T(1); }
+};
+
+template <typename Fn, typename T>
+void activate_span(int n, const T *z, T *y)
+{
+    for (int i = 0; i < n; i++)
+        y[i] = Fn::f(z[i]);
+}
+
+template <typename Fn, typename T>
+void gradient_span(int n, const T *z, const T *y, const T *e, T *out)
+{
+    for (int i = 0; i < n; i++)
+        out[i] = e[i] * Fn::df(z[i], y[i]);
+}
+
+/*the exponential based functions pass their SIMD span kernel as activate*/
+template <template <typename> class Fn, typename T>
+constexpr ActivationKernels<T> kernels_of(Activation kind, const char *name,
+                                          void (*activate)(int, const T *, T *) = activate_span<Fn<T>, T>)
+{
+    return {kind, name, activate, gradient_span<Fn<T>, T>};
+}
+
+/*indexed by Activation*/
+template <typename T>
+const ActivationKernels<T> registry[] = {
+    kernels_of<sigmoid_fn, T>(Activation::sigmoid, "sigmoid", sigmoid_fn<T>::span),
+    kernels_of<relu_fn, T>(Activation::relu, "relu"),
+    kernels_of<linear_fn, T>(Activation::linear, "linear"),
+    kernels_of<tanh_fn, T>(Activation::tanh, "tanh", tanh_fn<T>::span),
+    kernels_of<leaky_relu_fn, T>(Activation::leaky_relu, "leaky_relu"),
+    kernels_of<gelu_fn, T>(Activation::gelu, "gelu"),
+    kernels_of<softmax_fn, T>(Activation::softmax, "softmax", softmax_fn<T>::span),
+};
+
+}
+
+void set_activation_accuracy(phoenix::simd::accuracy acc)
+{
+    accuracy_setting().store(acc);
+}
+
+phoenix::simd::accuracy activation_accuracy()
+{
+    return accuracy_setting().load(std::memory_order_relaxed);
+}
+
+template <typename T>
+const ActivationKernels<T> &activation_kernels(Activation kind)
+{
+    return registry<T>[static_cast<int>(kind)];
+}
+
+template <typename T>
+const ActivationKernels<T> &activation_kernels(const std::string &name)
+{
+    for (const ActivationKernels<T> &k : registry<T>)
+    {
+        if (name == k.name)
+            return k;
+    }
 
+    throw std::invalid_argument("Unknown activation function " + name + ". ");
+}
 
+template const ActivationKernels<float> &activation_kernels<float>(Activation);
+template const ActivationKernels<double> &activation_kernels<double>(Activation);
+template const ActivationKernels<float> &activation_kernels<float>(const std::string &);
+template const ActivationKernels<double> &activation_kernels<double>(const std::string &);
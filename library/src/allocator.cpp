@@ -0,0 +1,51 @@
+#include "allocator.hpp"
+
+namespace phoenix {
+
+namespace {
+
+/*policy matrices on this thread allocate from, nullptr means the aligned heap*/
+thread_local StoragePolicy *current_policy = nullptr;
+
+std::size_t round_up(std::size_t bytes)
+{
+    return (bytes + storage_alignment - 1) & ~(storage_alignment - 1);
+}
+
+}
+
+AlignedHeap &AlignedHeap::instance()
+{
+    /*never destroyed, buffers of static matrices may be released after exit handlers run*/
+    static AlignedHeap *heap = new AlignedHeap();
+    return *heap;
+}
+
+void *AlignedHeap::allocate(std::size_t bytes)
+{
+    return ::operator new(round_up(bytes == 0 ? 1 : bytes), std::align_val_t(storage_alignment));
+}
+
+void AlignedHeap::deallocate(void *block, std::size_t /*bytes*/) noexcept
+{
+    ::operator delete(block, std::align_val_t(storage_alignment));
+}
+
+StoragePolicy &current_storage()
+{
+    if (current_policy == nullptr)
+        return AlignedHeap::instance();
+    return *current_policy;
+}
+
+StorageScope::StorageScope(StoragePolicy &policy) : previous_(current_policy)
+{
+    current_policy = &policy;
+}
+
+StorageScope::~StorageScope()
+{
+    current_policy = previous_;
+}
+
+}
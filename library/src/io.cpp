@@ -1,10 +1,11 @@
 #include "io.h"
 
 
-Matrix<double> ReadFileToMatrix(const std::string &filename, char delimeter)
+template <typename T>
+Matrix<T> ReadFileToMatrix(const std::string &filename, char delimeter)
 {
 
-    Matrix<double> matrix(1, 1);
+    Matrix<T> matrix(1, 1);
 
     std::ifstream file(filename);
     if (!file.is_open())
@@ -41,12 +42,12 @@ Matrix<double> ReadFileToMatrix(const std::string &filename, char delimeter)
             ++rows;
         }
 
-        matrix = Matrix<double>(rows, col);
+        matrix = Matrix<T>(rows, col);
         for (int i = 0; i < rows; ++i)
         {
             for (int j = 0; j < col; ++j)
             {
-                matrix(i, j) = values[i * col + j];
+                matrix(i, j) = static_cast<T>(values[i * col + j]);
             }
         }
 
@@ -62,3 +63,6 @@ Matrix<double> ReadFileToMatrix(const std::string &filename, char delimeter)
 
     return matrix;
 }
+
+template Matrix<float> ReadFileToMatrix<float>(const std::string &filename, char delimeter);
+template Matrix<double> ReadFileToMatrix<double>(const std::string &filename, char delimeter);
@@ -0,0 +1,574 @@
+#include "linalg.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "gemm.h"
+#include "threadpool.h"
+
+namespace {
+
+/*number of threads the blocks of an n x p problem are spread over*/
+int least_squares_shards(int n, int p, int blocks)
+{
+    if (!enable_parallel || static_cast<double>(n) * p * p < least_squares_parallel_threshold)
+        return 1;
+    return static_cast<int>(std::min<std::size_t>(ThreadPool::instance().size(), blocks));
+}
+
+/*copies rows [first, first + rows) of X with a trailing 1, and of Y, into row-major doubles*/
+template <typename T>
+void stage_rows(MatrixView<const T> X, MatrixView<const T> Y, int first, int rows, double *a, double *y)
+{
+    int d = X.getCols();
+    int m = Y.getCols();
+
+    for (int i = 0; i < rows; i++)
+    {
+        double *ai = a + static_cast<std::size_t>(i) * (d + 1);
+        for (int j = 0; j < d; j++)
+            ai[j] = X(first + i, j);
+        ai[d] = 1;
+
+        double *yi = y + static_cast<std::size_t>(i) * m;
+        for (int j = 0; j < m; j++)
+            yi[j] = Y(first + i, j);
+    }
+}
+
+/*rotates the row (x, y) into the triangular factor r and the rotated targets z, x and y are destroyed*/
+void givens_update(int p, int m, double *r, double *z, double *x, double *y)
+{
+    for (int j = 0; j < p; j++)
+    {
+        if (x[j] == 0)
+            continue;
+
+        double *rj = r + static_cast<std::size_t>(j) * p;
+        double *zj = z + static_cast<std::size_t>(j) * m;
+        double h = std::sqrt(rj[j] * rj[j] + x[j] * x[j]);
+        double c = rj[j] / h;
+        double s = x[j] / h;
+
+        rj[j] = h;
+        for (int k = j + 1; k < p; k++)
+        {
+            double t = rj[k];
+            rj[k] = c * t + s * x[k];
+            x[k] = c * x[k] - s * t;
+        }
+        for (int k = 0; k < m; k++)
+        {
+            double t = zj[k];
+            zj[k] = c * t + s * y[k];
+            y[k] = c * y[k] - s * t;
+        }
+    }
+}
+
+/**
+ * Stages every block of rows and hands it to body(rows, a, y, scratch, partial), spread over
+ * the thread pool for large problems. Each thread sums into its own partial of size doubles,
+ * the partials are added into out in shard order, so the sum does not depend on the thread count.
+ * scratch holds scratch_cols doubles per row of the block.
+ */
+template <typename T, typename F>
+void reduce_blocks(MatrixView<const T> X, MatrixView<const T> Y, std::size_t size, int scratch_cols, double *out, F &&body)
+{
+    int n = X.getRows();
+    int p = X.getCols() + 1;
+    int m = Y.getCols();
+    int blocks = (n + least_squares_block_rows - 1) / least_squares_block_rows;
+    int shards = least_squares_shards(n, p, blocks);
+
+    /*partial sums of the first shard go straight into out*/
+    std::vector<std::vector<double>> partial(shards - 1, std::vector<double>(size));
+    std::fill(out, out + size, 0.0);
+
+    auto reduce = [&](std::size_t w, std::size_t)
+    {
+        double *sum = w == 0 ? out : partial[w - 1].data();
+        std::vector<double> a(static_cast<std::size_t>(least_squares_block_rows) * p);
+        std::vector<double> y(static_cast<std::size_t>(least_squares_block_rows) * m);
+        std::vector<double> scratch(static_cast<std::size_t>(least_squares_block_rows) * scratch_cols);
+
+        for (int b = static_cast<int>(w); b < blocks; b += shards)
+        {
+            int first = b * least_squares_block_rows;
+            int rows = std::min(least_squares_block_rows, n - first);
+            stage_rows(X, Y, first, rows, a.data(), y.data());
+            body(rows, a.data(), y.data(), scratch.data(), sum);
+        }
+    };
+
+    if (shards > 1)
+        parallel_for(0, shards, 1, reduce);
+    else
+        reduce(0, 1);
+
+    for (int w = 1; w < shards; w++)
+    {
+        for (std::size_t i = 0; i < size; i++)
+            out[i] += partial[w - 1][i];
+    }
+}
+
+template <typename T>
+void check_least_squares(MatrixView<const T> X, MatrixView<const T> Y)
+{
+    if (X.getRows() != Y.getRows())
+    {
+        throw std::invalid_argument("The data and the targets must have the same number of rows. ");
+    }
+}
+
+/*least squares through Givens rotations of the data, ridge rows are appended as sqrt(ridge) * e_j*/
+template <typename T>
+Matrix<double> qr_least_squares(MatrixView<const T> X, MatrixView<const T> Y, double ridge)
+{
+    int n = X.getRows();
+    int p = X.getCols() + 1;
+    int m = Y.getCols();
+    int blocks = (n + least_squares_block_rows - 1) / least_squares_block_rows;
+    int shards = least_squares_shards(n, p, blocks);
+
+    std::vector<std::vector<double>> r(shards, std::vector<double>(static_cast<std::size_t>(p) * p, 0.0));
+    std::vector<std::vector<double>> z(shards, std::vector<double>(static_cast<std::size_t>(p) * m, 0.0));
+
+    auto reduce = [&](std::size_t w, std::size_t)
+    {
+        std::vector<double> a(static_cast<std::size_t>(least_squares_block_rows) * p);
+        std::vector<double> y(static_cast<std::size_t>(least_squares_block_rows) * m);
+
+        for (int b = static_cast<int>(w); b < blocks; b += shards)
+        {
+            int first = b * least_squares_block_rows;
+            int rows = std::min(least_squares_block_rows, n - first);
+            stage_rows(X, Y, first, rows, a.data(), y.data());
+
+            for (int i = 0; i < rows; i++)
+                givens_update(p, m, r[w].data(), z[w].data(), a.data() + static_cast<std::size_t>(i) * p,
+                              y.data() + static_cast<std::size_t>(i) * m);
+        }
+    };
+
+    if (shards > 1)
+        parallel_for(0, shards, 1, reduce);
+    else
+        reduce(0, 1);
+
+    /*the rows of the other factors are rotated into the first one, in shard order*/
+    std::vector<double> x(p), y(m);
+    for (int w = 1; w < shards; w++)
+    {
+        for (int j = 0; j < p; j++)
+        {
+            std::copy(r[w].begin() + static_cast<std::size_t>(j) * p, r[w].begin() + static_cast<std::size_t>(j + 1) * p, x.begin());
+            std::copy(z[w].begin() + static_cast<std::size_t>(j) * m, z[w].begin() + static_cast<std::size_t>(j + 1) * m, y.begin());
+            givens_update(p, m, r[0].data(), z[0].data(), x.data(), y.data());
+        }
+    }
+
+    for (int j = 0; ridge > 0 && j + 1 < p; j++)
+    {
+        std::fill(x.begin(), x.end(), 0.0);
+        std::fill(y.begin(), y.end(), 0.0);
+        x[j] = std::sqrt(ridge);
+        givens_update(p, m, r[0].data(), z[0].data(), x.data(), y.data());
+    }
+
+    const double *R = r[0].data();
+    double largest = 0;
+    for (int j = 0; j < p; j++)
+        largest = std::max(largest, std::abs(R[j * p + j]));
+
+    /*back substitution R w = z*/
+    Matrix<double> solution(p, m);
+    for (int j = p - 1; j >= 0; j--)
+    {
+        double diagonal = R[j * p + j];
+        if (!(std::abs(diagonal) > largest * p * std::numeric_limits<double>::epsilon()))
+        {
+            throw std::invalid_argument("The data matrix is rank deficient, add a ridge penalty. ");
+        }
+
+        for (int k = 0; k < m; k++)
+        {
+            double sum = z[0][static_cast<std::size_t>(j) * m + k];
+            for (int i = j + 1; i < p; i++)
+                sum -= R[j * p + i] * solution(i, k);
+            solution(j, k) = sum / diagonal;
+        }
+    }
+
+    return solution;
+}
+
+/*numerically safe log(1 + e^x)*/
+double softplus(double x)
+{
+    return std::max(x, 0.0) + std::log1p(std::exp(-std::abs(x)));
+}
+
+/**
+ * Summed cross-entropy of output k at the coefficients w, plus the ridge penalty.
+ * The gradient is always written, the Hessian only when hessian is not null.
+ */
+template <typename T>
+double logistic_objective(MatrixView<const T> X, MatrixView<const T> Y, int k, const double *w, double ridge,
+                          double *gradient, double *hessian)
+{
+    int p = X.getCols() + 1;
+    int m = Y.getCols();
+    std::size_t size = 1 + p + (hessian ? static_cast<std::size_t>(p) * p : 0);
+    std::vector<double> sums(size);
+
+    reduce_blocks(X, Y, size, hessian ? p + 2 : 2, sums.data(), [&](int rows, const double *a, const double *y, double *scratch, double *sum)
+    {
+        double *eta = scratch;
+        double *residual = scratch + rows;
+
+        /*eta = A w, then the loss, residuals and IRLS weights row by row*/
+        gemm(rows, 1, p, 1.0, a, p, 1, w, 1, 1, 0.0, eta, 1, 1);
+        for (int i = 0; i < rows; i++)
+        {
+            double target = y[static_cast<std::size_t>(i) * m + k];
+            double s = 1 / (1 + std::exp(-eta[i]));
+            sum[0] += softplus(eta[i]) - target * eta[i];
+            residual[i] = s - target;
+            eta[i] = s * (1 - s);
+        }
+
+        /*gradient A^T r, Hessian A^T diag(s (1 - s)) A*/
+        gemm(p, 1, rows, 1.0, a, 1, p, residual, 1, 1, 1.0, sum + 1, 1, 1);
+        if (hessian)
+        {
+            double *weighted = scratch + 2 * rows;
+            for (int i = 0; i < rows; i++)
+            {
+                for (int j = 0; j < p; j++)
+                    weighted[static_cast<std::size_t>(i) * p + j] = a[static_cast<std::size_t>(i) * p + j] * eta[i];
+            }
+            gemm(p, p, rows, 1.0, a, 1, p, weighted, p, 1, 1.0, sum + 1 + p, p, 1);
+        }
+    });
+
+    double loss = sums[0];
+    std::copy(sums.begin() + 1, sums.begin() + 1 + p, gradient);
+    if (hessian)
+        std::copy(sums.begin() + 1 + p, sums.end(), hessian);
+
+    for (int j = 0; j + 1 < p; j++)
+    {
+        loss += 0.5 * ridge * w[j] * w[j];
+        gradient[j] += ridge * w[j];
+        if (hessian)
+            hessian[static_cast<std::size_t>(j) * p + j] += ridge;
+    }
+
+    return loss;
+}
+
+double dot(const std::vector<double> &x, const std::vector<double> &y)
+{
+    double sum = 0;
+    for (std::size_t i = 0; i < x.size(); i++)
+        sum += x[i] * y[i];
+    return sum;
+}
+
+double largest_entry(const std::vector<double> &x)
+{
+    double largest = 0;
+    for (double v : x)
+        largest = std::max(largest, std::abs(v));
+    return largest;
+}
+
+/*Armijo constant and the most step halvings of the line searches*/
+constexpr double armijo = 1e-4;
+constexpr int max_halvings = 40;
+
+/**
+ * Backtracks from w along direction until the loss decreases enough, slope is gradient . direction.
+ * On success w, loss and gradient hold the new point. Trials never form the Hessian.
+ */
+template <typename T>
+bool line_search(MatrixView<const T> X, MatrixView<const T> Y, int k, double ridge,
+                 std::vector<double> &w, double &loss, std::vector<double> &gradient,
+                 const std::vector<double> &direction, double slope)
+{
+    std::size_t p = w.size();
+    std::vector<double> trial(p), trial_gradient(p);
+    double step = 1;
+
+    for (int h = 0; h < max_halvings; h++, step *= 0.5)
+    {
+        for (std::size_t j = 0; j < p; j++)
+            trial[j] = w[j] + step * direction[j];
+
+        double trial_loss = logistic_objective(X, Y, k, trial.data(), ridge, trial_gradient.data(), nullptr);
+        if (trial_loss <= loss + armijo * step * slope)
+        {
+            w.swap(trial);
+            gradient.swap(trial_gradient);
+            loss = trial_loss;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*IRLS: Newton steps on the cross-entropy, each solving H d = -g with Cholesky*/
+template <typename T>
+void newton_logistic(MatrixView<const T> X, MatrixView<const T> Y, int k, double ridge, int max_iterations,
+                     double tolerance, std::vector<double> &w)
+{
+    int p = static_cast<int>(w.size());
+    double n = std::max(X.getRows(), 1);
+    std::vector<double> gradient(p), hessian(static_cast<std::size_t>(p) * p), direction(p);
+    double loss = logistic_objective(X, Y, k, w.data(), ridge, gradient.data(), hessian.data());
+
+    for (int it = 0; it < max_iterations && largest_entry(gradient) > tolerance * n; it++)
+    {
+        Matrix<double> h(p, p), d(p, 1);
+        std::copy(hessian.begin(), hessian.end(), h.getdata());
+        for (int j = 0; j < p; j++)
+            d(j, 0) = -gradient[j];
+        cholesky_solve(h, d);
+        std::copy(d.getdata(), d.getdata() + p, direction.begin());
+
+        if (!line_search(X, Y, k, ridge, w, loss, gradient, direction, dot(gradient, direction)))
+            break;
+
+        /*the O(n p^2) Hessian is formed once per accepted point, not per trial step*/
+        logistic_objective(X, Y, k, w.data(), ridge, gradient.data(), hessian.data());
+    }
+}
+
+/*L-BFGS with the two-loop recursion over the last lbfgs_memory pairs*/
+template <typename T>
+void lbfgs_logistic(MatrixView<const T> X, MatrixView<const T> Y, int k, double ridge, int max_iterations,
+                    double tolerance, std::vector<double> &w)
+{
+    std::size_t p = w.size();
+    double n = std::max(X.getRows(), 1);
+    std::vector<double> gradient(p), direction(p), previous_w(p), previous_gradient(p);
+    std::vector<std::vector<double>> s, y;
+    std::vector<double> rho, alpha(lbfgs_memory);
+    double loss = logistic_objective(X, Y, k, w.data(), ridge, gradient.data(), nullptr);
+
+    for (int it = 0; it < max_iterations && largest_entry(gradient) > tolerance * n; it++)
+    {
+        /*direction = -H g, H the inverse Hessian approximation*/
+        for (std::size_t j = 0; j < p; j++)
+            direction[j] = -gradient[j];
+
+        int pairs = static_cast<int>(s.size());
+        for (int i = pairs - 1; i >= 0; i--)
+        {
+            alpha[i] = rho[i] * dot(s[i], direction);
+            for (std::size_t j = 0; j < p; j++)
+                direction[j] -= alpha[i] * y[i][j];
+        }
+
+        /*without history the first step is scaled to unit length*/
+        double gamma = pairs ? dot(s[pairs - 1], y[pairs - 1]) / dot(y[pairs - 1], y[pairs - 1])
+                             : 1 / std::sqrt(dot(gradient, gradient));
+        for (std::size_t j = 0; j < p; j++)
+            direction[j] *= gamma;
+
+        for (int i = 0; i < pairs; i++)
+        {
+            double beta = rho[i] * dot(y[i], direction);
+            for (std::size_t j = 0; j < p; j++)
+                direction[j] += (alpha[i] - beta) * s[i][j];
+        }
+
+        double slope = dot(gradient, direction);
+        if (!(slope < 0))
+        {
+            /*lost descent, restart from steepest descent*/
+            s.clear();
+            y.clear();
+            rho.clear();
+            for (std::size_t j = 0; j < p; j++)
+                direction[j] = -gradient[j] / std::sqrt(dot(gradient, gradient));
+            slope = dot(gradient, direction);
+        }
+
+        previous_w = w;
+        previous_gradient = gradient;
+        if (!line_search(X, Y, k, ridge, w, loss, gradient, direction, slope))
+            break;
+
+        std::vector<double> step(p), change(p);
+        for (std::size_t j = 0; j < p; j++)
+        {
+            step[j] = w[j] - previous_w[j];
+            change[j] = gradient[j] - previous_gradient[j];
+        }
+
+        /*only pairs with positive curvature keep the approximation positive definite*/
+        double curvature = dot(step, change);
+        if (curvature > std::numeric_limits<double>::epsilon() * dot(change, change))
+        {
+            if (static_cast<int>(s.size()) == lbfgs_memory)
+            {
+                s.erase(s.begin());
+                y.erase(y.begin());
+                rho.erase(rho.begin());
+            }
+            s.push_back(step);
+            y.push_back(change);
+            rho.push_back(1 / curvature);
+        }
+    }
+}
+
+}
+
+template <typename T>
+void normal_equations(MatrixView<const T> X, MatrixView<const T> Y, Matrix<double> &xtx, Matrix<double> &xty)
+{
+    check_least_squares(X, Y);
+
+    int p = X.getCols() + 1;
+    int m = Y.getCols();
+
+    if (xtx.getRows() != p || xtx.getCols() != p || xty.getRows() != p || xty.getCols() != m)
+    {
+        throw std::invalid_argument("The normal equations must be (cols + 1) x (cols + 1) and (cols + 1) x outputs. ");
+    }
+
+    /*[X 1]^T [X 1] followed by [X 1]^T Y, A^T is a stride swap of the staged block*/
+    std::size_t gram = static_cast<std::size_t>(p) * p;
+    std::vector<double> sums(gram + static_cast<std::size_t>(p) * m);
+
+    reduce_blocks(X, Y, sums.size(), 0, sums.data(), [&](int rows, const double *a, const double *y, double *, double *sum)
+    {
+        gemm(p, p, rows, 1.0, a, 1, p, a, p, 1, 1.0, sum, p, 1);
+        gemm(p, m, rows, 1.0, a, 1, p, y, m, 1, 1.0, sum + gram, m, 1);
+    });
+
+    std::copy(sums.begin(), sums.begin() + gram, xtx.getdata());
+    std::copy(sums.begin() + gram, sums.end(), xty.getdata());
+}
+
+void cholesky_solve(Matrix<double> &a, Matrix<double> &b)
+{
+    int p = a.getRows();
+    int m = b.getCols();
+
+    if (a.getCols() != p || b.getRows() != p)
+    {
+        throw std::invalid_argument("Cholesky needs a square matrix and right hand sides with as many rows. ");
+    }
+
+    /*A = L L^T, L overwrites the lower triangle*/
+    for (int j = 0; j < p; j++)
+    {
+        double diagonal = a(j, j);
+        double d = diagonal;
+        for (int k = 0; k < j; k++)
+            d -= a(j, k) * a(j, k);
+
+        if (!(d > diagonal * p * std::numeric_limits<double>::epsilon()))
+        {
+            throw std::invalid_argument("The normal equations are not positive definite, use the QR solver or a ridge penalty. ");
+        }
+
+        double l = std::sqrt(d);
+        a(j, j) = l;
+        for (int i = j + 1; i < p; i++)
+        {
+            double s = a(i, j);
+            for (int k = 0; k < j; k++)
+                s -= a(i, k) * a(j, k);
+            a(i, j) = s / l;
+        }
+    }
+
+    /*L y = b, then L^T x = y*/
+    for (int k = 0; k < m; k++)
+    {
+        for (int i = 0; i < p; i++)
+        {
+            double s = b(i, k);
+            for (int j = 0; j < i; j++)
+                s -= a(i, j) * b(j, k);
+            b(i, k) = s / a(i, i);
+        }
+        for (int i = p - 1; i >= 0; i--)
+        {
+            double s = b(i, k);
+            for (int j = i + 1; j < p; j++)
+                s -= a(j, i) * b(j, k);
+            b(i, k) = s / a(i, i);
+        }
+    }
+}
+
+template <typename T>
+Matrix<double> least_squares(MatrixView<const T> X, MatrixView<const T> Y, LinearSolver solver, double ridge)
+{
+    check_least_squares(X, Y);
+
+    if (!(ridge >= 0))
+    {
+        throw std::invalid_argument("The ridge penalty must not be negative. ");
+    }
+
+    if (solver == LinearSolver::qr)
+        return qr_least_squares(X, Y, ridge);
+
+    int p = X.getCols() + 1;
+    Matrix<double> xtx(p, p);
+    Matrix<double> solution(p, Y.getCols());
+    normal_equations(X, Y, xtx, solution);
+
+    for (int j = 0; j + 1 < p; j++)
+        xtx(j, j) += ridge;
+
+    cholesky_solve(xtx, solution);
+    return solution;
+}
+
+template <typename T>
+Matrix<double> logistic_regression(MatrixView<const T> X, MatrixView<const T> Y, LogisticSolver solver,
+                                   double ridge, int max_iterations, double tolerance)
+{
+    check_least_squares(X, Y);
+
+    if (!(ridge >= 0))
+    {
+        throw std::invalid_argument("The ridge penalty must not be negative. ");
+    }
+
+    int p = X.getCols() + 1;
+    Matrix<double> solution(p, Y.getCols());
+
+    for (int k = 0; k < Y.getCols(); k++)
+    {
+        std::vector<double> w(p, 0.0);
+
+        if (solver == LogisticSolver::newton)
+            newton_logistic(X, Y, k, ridge, max_iterations, tolerance, w);
+        else
+            lbfgs_logistic(X, Y, k, ridge, max_iterations, tolerance, w);
+
+        for (int j = 0; j < p; j++)
+            solution(j, k) = w[j];
+    }
+
+    return solution;
+}
+
+template void normal_equations<float>(MatrixView<const float>, MatrixView<const float>, Matrix<double> &, Matrix<double> &);
+template void normal_equations<double>(MatrixView<const double>, MatrixView<const double>, Matrix<double> &, Matrix<double> &);
+template Matrix<double> least_squares<float>(MatrixView<const float>, MatrixView<const float>, LinearSolver, double);
+template Matrix<double> least_squares<double>(MatrixView<const double>, MatrixView<const double>, LinearSolver, double);
+template Matrix<double> logistic_regression<float>(MatrixView<const float>, MatrixView<const float>, LogisticSolver, double, int, double);
+template Matrix<double> logistic_regression<double>(MatrixView<const double>, MatrixView<const double>, LogisticSolver, double, int, double);
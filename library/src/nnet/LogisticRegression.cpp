@@ -1,53 +1,70 @@
     #include "LogisticRegression.h"
 
-    LogisticRegression::LogisticRegression(Matrix<double> &rin,
-                                    Matrix<double> &rout) : NeuralModel(rin, rout, {rout.getCols()}, 0.001), input(rin) , output(rout)
+    template <typename T>
+    LogisticRegression<T>::LogisticRegression(Matrix<T> &rin,
+                                    Matrix<T> &rout) : NeuralModel<T>(rin, rout, {rout.getCols()}, 0.001), input(rin) , output(rout)
     {
         num_inputs = rin.getCols();
         num_hidden = 1;
         num_outputs = rout.getCols();
         learning_rate = 0.001;
         H.push_back(num_outputs);
-        NeuralModel::NNConnfigure({"linear", "sigmoid"});
+        NeuralModel<T>::NNConnfigure({"linear", "sigmoid"});
     }
 
-    LogisticRegression::LogisticRegression(): NeuralModel()
+    template <typename T>
+    LogisticRegression<T>::LogisticRegression(): NeuralModel<T>()
     {
 
     }
                  
 
     
-    void LogisticRegression::train(int epochs){
+    template <typename T>
+    void LogisticRegression<T>::train(int epochs){
          double error;
 
          for (int count = 0; count < epochs; count++)
          {
            error = 0;
-           for(int i = 0; i < input.getRows(); i++)
-            {
-              auto in = convert_row(input, i);
-              auto target = convert_row(output, i);
-
-              NeuralModel::forward_propagation(in);
-              NeuralModel::back_propagation(target);
-
-            error += total_error(target,  NeuralModel::NNPredicted());
-          }
+           if (NeuralModel<T>::batched_training())
+             error = NeuralModel<T>::train_batches(input, output);
+           else
+           {
+             for(int i = 0; i < input.getRows(); i++)
+              {
+                VectorView<const T> in = input.row(i);
+                VectorView<const T> target = output.row(i);
+
+                /*the step runs in the model buffers and returns the loss of the sample*/
+                NeuralModel<T>::forward_propagation(in);
+                error += NeuralModel<T>::back_propagation(target);
+            }
+           }
           error = error/input.getRows();
            std::cout<<"Epoch----- "<< count << " Error: "<<error<<std::endl;
          }
  }
 
 
-    void LogisticRegression::save(std::string filename) {
+    template <typename T>
+    double LogisticRegression<T>::fit(LogisticSolver solver, double ridge, int max_iterations, double tolerance){
+        NeuralModel<T>::check_affine_layers(Activation::sigmoid);
+
+        Matrix<double> solution = logistic_regression<T>(input.view(), output.view(), solver, ridge, max_iterations, tolerance);
+        return NeuralModel<T>::load_linear_solution(solution, input, output);
+    }
+
+    template <typename T>
+    void LogisticRegression<T>::save(std::string filename) {
 
         std::ofstream file(filename, std::ios::out | std::ios::binary);
         if (!file) {
             std::cerr << "Error: Could not open file " << filename << " for writing\n";
             return;
         }
-        
+
+        write_precision<T>(file);
         file.write(reinterpret_cast<char*>(&num_inputs), sizeof(num_inputs));
         file.write(reinterpret_cast<char*>(&num_hidden), sizeof(num_hidden));
         file.write(reinterpret_cast<char*>(&num_outputs), sizeof(num_outputs));
@@ -58,33 +75,23 @@
             file.write(reinterpret_cast<char*>(&vals), sizeof(vals));
         }
         
-        int network_size = NeuralModel::network.size() - 1;
-        for (int i = 1; i < network_size; i = i+2 )
-        {
-            Matrix<double> weight = NeuralModel::network[i];
-            file.write(reinterpret_cast<char*>(weight.getdata()), weight.size() * sizeof(double)) ;       
-
-        }
-
-                
-        
-        int bias_size = NeuralModel::B.size();
-        for (int i = 0; i < bias_size; i++ )
-        {
-            Vector<double> bias = NeuralModel::B[i];
-            file.write(reinterpret_cast<char*>(bias.getdata()), bias.size() * sizeof(double)) ;       
-
-        }
+        /*weights then biases, written straight from the parameter buffer*/
+        ParameterBuffer<T> &params = NeuralModel<T>::params;
+        file.write(reinterpret_cast<char*>(params.data()), params.size() * sizeof(T));
         file.close();
     }
 
 
-    void LogisticRegression::load(std::string filename) {
+    template <typename T>
+    void LogisticRegression<T>::load(std::string filename) {
         std::ifstream file(filename, std::ios::in | std::ios::binary);
         if (!file) {
             std::cerr << "Error: Could not open file " << filename << " for reading\n";
             return;
         }
+        if (!check_precision<T>(file, filename))
+            return;
+
         file.read(reinterpret_cast<char*>(&num_inputs), sizeof(num_inputs));
         file.read(reinterpret_cast<char*>(&num_hidden), sizeof(num_hidden));
         file.read(reinterpret_cast<char*>(&num_outputs), sizeof(num_outputs));
@@ -100,40 +107,37 @@
 
         }
 
-        NNBuild(num_inputs, num_outputs, nl);
-
-        int network_size = NeuralModel::network.size() - 1;
-        for (int i = 1; i < network_size; i = i+2 )
-        {
-            Matrix<double> &weight =  NeuralModel::network[i];
-           file.read(reinterpret_cast<char*>(weight.getdata()), weight.size() * sizeof(double));   
-
-        }
-
-        B.clear();
-        for (int i = 0; i < num_hidden; i++ )
-        {
-            Vector<double> bias(nl[i]);
-            file.read(reinterpret_cast<char*>(bias.getdata()), bias.size() * sizeof(double));  
-            B.push_back(bias);
+        H = nl;
+        NeuralModel<T>::NNBuild(num_inputs, num_outputs, nl);
 
+        /*the file holds the parameter buffer as laid out by NNBuild*/
+        ParameterBuffer<T> &params = NeuralModel<T>::params;
+        if (!file || remaining_bytes(file) != params.size() * sizeof(T)) {
+            std::cerr << "Error: " << filename << " does not hold the parameters of its layer sizes\n";
+            return;
         }
+        file.read(reinterpret_cast<char*>(params.data()), params.size() * sizeof(T));
         file.close();
     }
 
 
-    void LogisticRegression::configure(std::initializer_list<std::string>& act_value)
+    template <typename T>
+    void LogisticRegression<T>::configure(std::initializer_list<std::string>& act_value)
    {
-        NeuralModel::NNConnfigure(act_value);
+        NeuralModel<T>::NNConnfigure(act_value);
    }
 
-    Vector<double> LogisticRegression::predict(const Vector<double> &predict){
-        int count = NeuralModel::network.size() - 1;
+    template <typename T>
+    Vector<T> LogisticRegression<T>::predict(const Vector<T> &predict){
+        int count = NeuralModel<T>::network.size() - 1;
 
-        NeuralModel::forward_propagation(predict);
+        NeuralModel<T>::forward_propagation(predict);
 
-        Vector<double> output =  convert_col(NeuralModel::network[count], 0);
+        Vector<T> output =  convert_col(NeuralModel<T>::network[count], 0);
 
     return (output);
 
-  }
\ No newline at end of file
+  }
+
+template class LogisticRegression<float>;
+template class LogisticRegression<double>;
@@ -0,0 +1,134 @@
+#include "ModelSearch.h"
+
+#include <config.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include "threadpool.h"
+
+template <typename T>
+ModelSearch<T>::ModelSearch(const Matrix<T> &in, const Matrix<T> &out, const Matrix<T> &valid_in, const Matrix<T> &valid_out)
+    : input(in), output(out), valid_input(valid_in), valid_output(valid_out)
+{
+    if (in.getRows() != out.getRows() || valid_in.getRows() != valid_out.getRows())
+    {
+        throw std::invalid_argument("The input and output matrices must have the same number of rows. ");
+    }
+    if (valid_in.getCols() != in.getCols() || valid_out.getCols() != out.getCols())
+    {
+        throw std::invalid_argument("The validation data must have the columns of the training data. ");
+    }
+}
+
+template <typename T>
+void ModelSearch<T>::add(const SearchConfig &config)
+{
+    if (config.activations.size() != config.hidden.size() + 1)
+    {
+        throw std::invalid_argument("A configuration needs one activation per hidden layer plus the output layer. ");
+    }
+
+    /*built here so that an invalid configuration throws from add*/
+    candidate c;
+    c.config = config;
+    c.model.reset(new SimpleNeuralNetwork<T>(input, output, config.hidden, config.learning_rate));
+    c.model->configure(config.activations);
+    c.model->setBatchSize(config.batch_size);
+    candidates.push_back(std::move(c));
+    winner = -1;
+}
+
+template <typename T>
+int ModelSearch<T>::run(int min_epochs, int max_epochs, int eta)
+{
+    if (candidates.empty())
+    {
+        throw std::invalid_argument("Add at least one configuration before running the search. ");
+    }
+    if (min_epochs < 1 || max_epochs < min_epochs || eta < 2)
+    {
+        throw std::invalid_argument("The search needs 1 <= min_epochs <= max_epochs and eta >= 2. ");
+    }
+
+    std::vector<int> alive(candidates.size());
+    std::iota(alive.begin(), alive.end(), 0);
+
+    int budget = min_epochs;
+    for (int round = 0;; round++)
+    {
+        /*every surviving model trains up to the budget and is scored on its own thread*/
+        auto body = [&](std::size_t first, std::size_t last)
+        {
+            for (std::size_t i = first; i < last; i++)
+            {
+                candidate &c = candidates[alive[i]];
+                for (; c.epochs < budget; c.epochs++)
+                    c.model->train_epoch();
+
+                double score = c.model->loss(valid_input, valid_output);
+                c.score = std::isfinite(score) ? score : std::numeric_limits<double>::infinity();
+            }
+        };
+
+        if (enable_parallel)
+            parallel_for(0, alive.size(), 1, body);
+        else
+            body(0, alive.size());
+
+        /*ties keep the order in which the configurations were added*/
+        std::stable_sort(alive.begin(), alive.end(), [&](int a, int b)
+                         { return candidates[a].score < candidates[b].score; });
+
+        std::cout << "Round----- " << round << " Epochs: " << budget << " Models: " << alive.size()
+                  << " Best: " << candidates[alive[0]].score << std::endl;
+
+        if (budget >= max_epochs)
+            break;
+
+        /*the weaker models are dropped, the last survivor goes straight to max_epochs*/
+        alive.resize(std::max<std::size_t>(1, alive.size() / eta));
+        budget = (alive.size() == 1) ? max_epochs : std::min(max_epochs, budget * eta);
+    }
+
+    winner = alive[0];
+    return winner;
+}
+
+template <typename T>
+const typename ModelSearch<T>::candidate &ModelSearch<T>::best_candidate() const
+{
+    if (winner < 0)
+    {
+        throw std::invalid_argument("The search has not been run. ");
+    }
+    return candidates[winner];
+}
+
+template <typename T>
+const SearchConfig &ModelSearch<T>::best_config() const
+{
+    return best_candidate().config;
+}
+
+template <typename T>
+SimpleNeuralNetwork<T> &ModelSearch<T>::best()
+{
+    return *best_candidate().model;
+}
+
+template <typename T>
+double ModelSearch<T>::best_loss() const
+{
+    return best_candidate().score;
+}
+
+template <typename T>
+void ModelSearch<T>::save(std::string filename)
+{
+    best().save(filename);
+}
+
+template class ModelSearch<float>;
+template class ModelSearch<double>;
@@ -0,0 +1,252 @@
+#include "QuantizedModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+/*tag at the start of a quantized model file*/
+const char quantized_magic[4] = {'P', 'H', 'Q', '8'};
+
+/*symmetric int8 range, -128 is left out so that negation stays exact*/
+const float qmax = 127.0f;
+
+/*clamps, then rounds half away from zero without a call into libm*/
+std::int8_t quantize(float value, float inv_scale)
+{
+    float q = std::min(qmax, std::max(-qmax, value * inv_scale));
+    return static_cast<std::int8_t>(q >= 0.0f ? q + 0.5f : q - 0.5f);
+}
+
+float scale_of(float range)
+{
+    return range > 0.0f ? range / qmax : 1.0f;
+}
+
+}
+
+QuantizedModel::QuantizedModel()
+{
+}
+
+template <typename T>
+QuantizedModel::QuantizedModel(NeuralModel<T> &model, Matrix<T> &calibration, int samples)
+{
+    int count = model.no_hid + 1;
+
+    if (calibration.getCols() != model.network[1].getCols())
+    {
+        throw std::invalid_argument("The number of calibration columns must be equal to the model input. ");
+    }
+
+    /*largest magnitude seen at the input of every layer*/
+    std::vector<float> range(count, 0.0f);
+    int rows = std::min(samples, calibration.getRows());
+
+    for (int s = 0; s < rows; s++)
+    {
+        VectorView<const T> in = calibration.row(s);
+        model.forward_propagation(in);
+
+        for (int l = 0; l < count; l++)
+        {
+            VectorView<const T> x = (l == 0) ? in : VectorView<const T>(model.network[2 * l].col(0));
+            for (int i = 0; i < x.size(); i++)
+                range[l] = std::max(range[l], std::abs(static_cast<float>(x[i])));
+        }
+    }
+
+    for (int l = 0; l < count; l++)
+    {
+        Matrix<T> &weight = model.network[2 * l + 1];
+
+        layer q;
+        q.rows = weight.getRows();
+        q.cols = weight.getCols();
+        q.act = activation_code(model.A[l].name);
+        q.input_scale = scale_of(range[l]);
+        q.weight_scale.resize(q.rows);
+        q.bias.assign(q.rows, 0.0f);
+        q.weight.resize(static_cast<std::size_t>(q.rows) * q.cols);
+
+        /*one scale per output channel*/
+        for (int r = 0; r < q.rows; r++)
+        {
+            float w_range = 0.0f;
+            for (int c = 0; c < q.cols; c++)
+                w_range = std::max(w_range, std::abs(static_cast<float>(weight(r, c))));
+
+            q.weight_scale[r] = scale_of(w_range);
+            float inv = 1.0f / q.weight_scale[r];
+            for (int c = 0; c < q.cols; c++)
+                q.weight[r * q.cols + c] = quantize(static_cast<float>(weight(r, c)), inv);
+        }
+
+        /*the float model adds no bias to the output layer*/
+        if (l < model.no_hid)
+        {
+            for (int r = 0; r < q.rows; r++)
+                q.bias[r] = static_cast<float>(model.B[l][r]);
+        }
+
+        layers.push_back(q);
+    }
+
+    allocate_scratch();
+}
+
+int QuantizedModel::activation_code(const std::string &name)
+{
+    return static_cast<int>(activation_kernels<float>(name).kind);
+}
+
+void QuantizedModel::allocate_scratch()
+{
+    int max_rows = 0;
+    int max_cols = 0;
+    for (const layer &q : layers)
+    {
+        max_rows = std::max(max_rows, q.rows);
+        max_cols = std::max(max_cols, q.cols);
+    }
+
+    xq.assign(max_cols, 0);
+    acc.assign(max_rows, 0);
+    hidden.assign(2 * static_cast<std::size_t>(max_rows), 0.0f);
+}
+
+const float *QuantizedModel::forward(const float *input)
+{
+    const float *x = input;
+    std::size_t half = hidden.size() / 2;
+
+    for (std::size_t l = 0; l < layers.size(); l++)
+    {
+        const layer &q = layers[l];
+
+        float inv = 1.0f / q.input_scale;
+        for (int i = 0; i < q.cols; i++)
+            xq[i] = quantize(x[i], inv);
+
+        simd::gemv(q.rows, q.cols, q.weight.data(), q.cols, xq.data(), acc.data());
+
+        /*layers alternate between the two halves of the scratch buffer*/
+        float *out = hidden.data() + (l % 2) * half;
+        for (int r = 0; r < q.rows; r++)
+        {
+            out[r] = static_cast<float>(acc[r]) * (q.weight_scale[r] * q.input_scale) + q.bias[r];
+        }
+        activation_kernels<float>(static_cast<Activation>(q.act)).activate(q.rows, out, out);
+        x = out;
+    }
+
+    return x;
+}
+
+template <typename T>
+Vector<T> QuantizedModel::predict(const Vector<T> &predict)
+{
+    if (layers.empty() || predict.getRows() != layers.front().cols)
+    {
+        throw std::invalid_argument("The number of vector rows must be equal to the model input. ");
+    }
+
+    const float *out;
+    if constexpr (std::is_same_v<T, float>)
+    {
+        out = forward(predict.getdata());
+    }
+    else
+    {
+        staged_input.resize(predict.getRows());
+        for (int i = 0; i < predict.getRows(); i++)
+            staged_input[i] = static_cast<float>(predict[i]);
+        out = forward(staged_input.data());
+    }
+
+    Vector<T> output(layers.back().rows);
+    for (int r = 0; r < layers.back().rows; r++)
+        output[r] = static_cast<T>(out[r]);
+
+    return (output);
+}
+
+void QuantizedModel::save(std::string filename)
+{
+    std::ofstream file(filename, std::ios::out | std::ios::binary);
+    if (!file) {
+        std::cerr << "Error: Could not open file " << filename << " for writing\n";
+        return;
+    }
+
+    int count = layers.size();
+    file.write(quantized_magic, sizeof(quantized_magic));
+    file.write(reinterpret_cast<char*>(&count), sizeof(count));
+
+    for (layer &q : layers)
+    {
+        file.write(reinterpret_cast<char*>(&q.rows), sizeof(q.rows));
+        file.write(reinterpret_cast<char*>(&q.cols), sizeof(q.cols));
+        file.write(reinterpret_cast<char*>(&q.act), sizeof(q.act));
+        file.write(reinterpret_cast<char*>(&q.input_scale), sizeof(q.input_scale));
+        file.write(reinterpret_cast<char*>(q.weight_scale.data()), q.rows * sizeof(float));
+        file.write(reinterpret_cast<char*>(q.bias.data()), q.rows * sizeof(float));
+        file.write(reinterpret_cast<char*>(q.weight.data()), q.weight.size() * sizeof(std::int8_t));
+    }
+    file.close();
+}
+
+void QuantizedModel::load(std::string filename)
+{
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    if (!file) {
+        std::cerr << "Error: Could not open file " << filename << " for reading\n";
+        return;
+    }
+
+    char magic[sizeof(quantized_magic)];
+    file.read(magic, sizeof(magic));
+    if (!file || std::memcmp(magic, quantized_magic, sizeof(magic)) != 0) {
+        std::cerr << "Error: " << filename << " is not a quantized model\n";
+        return;
+    }
+
+    int count = 0;
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+
+    layers.clear();
+    for (int l = 0; l < count; l++)
+    {
+        layer q;
+        file.read(reinterpret_cast<char*>(&q.rows), sizeof(q.rows));
+        file.read(reinterpret_cast<char*>(&q.cols), sizeof(q.cols));
+        file.read(reinterpret_cast<char*>(&q.act), sizeof(q.act));
+        if (q.act < 0 || q.act > static_cast<int>(Activation::softmax))
+        {
+            std::cerr << "Error: " << filename << " uses an unknown activation function\n";
+            layers.clear();
+            return;
+        }
+        file.read(reinterpret_cast<char*>(&q.input_scale), sizeof(q.input_scale));
+
+        q.weight_scale.resize(q.rows);
+        q.bias.resize(q.rows);
+        q.weight.resize(static_cast<std::size_t>(q.rows) * q.cols);
+        file.read(reinterpret_cast<char*>(q.weight_scale.data()), q.rows * sizeof(float));
+        file.read(reinterpret_cast<char*>(q.bias.data()), q.rows * sizeof(float));
+        file.read(reinterpret_cast<char*>(q.weight.data()), q.weight.size() * sizeof(std::int8_t));
+
+        layers.push_back(q);
+    }
+    file.close();
+
+    allocate_scratch();
+}
+
+template QuantizedModel::QuantizedModel(NeuralModel<float> &model, Matrix<float> &calibration, int samples);
+template QuantizedModel::QuantizedModel(NeuralModel<double> &model, Matrix<double> &calibration, int samples);
+
+template Vector<float> QuantizedModel::predict(const Vector<float> &predict);
+template Vector<double> QuantizedModel::predict(const Vector<double> &predict);
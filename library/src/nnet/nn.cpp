@@ -1,10 +1,19 @@
 #include "nn.h"
 
-NeuralModel::NeuralModel()
+namespace {
+
+/*rows per forward pass when a whole data set is evaluated*/
+constexpr int evaluation_rows = 64;
+
+}
+
+template <typename T>
+NeuralModel<T>::NeuralModel()
 {}
 
-NeuralModel::NeuralModel(Matrix<double> &in,
-                         Matrix<double> &out,
+template <typename T>
+NeuralModel<T>::NeuralModel(Matrix<T> &in,
+                         Matrix<T> &out,
                          std::initializer_list<int> hidden_neurons,
                          double rate) : feature(in), label(out), hid_list(hidden_neurons), learning_rate(rate)
 {
@@ -13,8 +22,24 @@ NeuralModel::NeuralModel(Matrix<double> &in,
   NNBuild(feature.getCols(), label.getCols(), hiddn);
 }
 
+template <typename T>
+NeuralModel<T>::NeuralModel(Matrix<T> &in,
+                         Matrix<T> &out,
+                         const std::vector<int> &hidden_neurons,
+                         double rate) : feature(in), label(out), hiddn(hidden_neurons), learning_rate(rate)
+{
+  NNBuild(feature.getCols(), label.getCols(), hiddn);
+}
+
+
+template <typename T>
+void NeuralModel<T>::NNConnfigure(std::initializer_list<std::string> act_function)
+{
+  NNConnfigure(std::vector<std::string>(act_function));
+}
 
-void NeuralModel::NNConnfigure(std::initializer_list<std::string> act_function)
+template <typename T>
+void NeuralModel<T>::NNConnfigure(const std::vector<std::string> &act_function)
 {
 
   if (!A.empty())
@@ -22,169 +47,859 @@ void NeuralModel::NNConnfigure(std::initializer_list<std::string> act_function)
     A.clear();
   }
 
+  /*names are resolved once, training calls the kernels directly*/
   for (auto fn : act_function)
   {
-    act activationType;
+    A.push_back({&activation_kernels<T>(fn), fn});
+  }
 
-    if (fn == "sigmoid")
-    {
-      activationType.activation = sigmoid;
-      activationType.derivative = sigmoid_derivative;
-    }
-    else if (fn == "relu")
-    {
-      activationType.activation = relu;
-      activationType.derivative = relu_derivative;
-    }
-    else if (fn == "linear")
-    {
-      activationType.activation = linear;
-      activationType.derivative = linear_derivative;
-    }
-    else
+  /*the softmax gradient is only right fused with the cross-entropy of the output*/
+  for (std::size_t l = 0; l + 1 < A.size(); l++)
+  {
+    if (A[l].kernels->kind == Activation::softmax)
     {
-      std::cout << "invalid actvation function" << std::endl;
+      throw std::invalid_argument("Softmax is only supported on the output layer. ");
     }
-    A.push_back(activationType);
   }
 }
 
 
-void NeuralModel::NNBuild(int input_size, int output_size, std::vector<int> &hids)
+template <typename T>
+void NeuralModel<T>::NNBuild(int input_size, int output_size, std::vector<int> &hids)
 {
 
-  int bk_n = input_size; 
   no_hid = hids.size();
-  Vector<double> input(bk_n);
 
+  /*all weights and biases live in one buffer, laid out in save order*/
+  std::vector<int> sizes;
+  sizes.push_back(input_size);
+  sizes.insert(sizes.end(), hids.begin(), hids.end());
+  sizes.push_back(output_size);
+  params = ParameterBuffer<T>(sizes);
+
+  network = Tensor<T>();
+  B.clear();
+  pre_activation.clear();
+  batch = batch_workspace();
+  replicas.clear();
+  gradients.clear();
+  gradient = ParameterBuffer<T>();
+  if (optimizer)
+    optimizer->reset();
+
+  Vector<T> input(input_size);
   network.addMatrix(input);
 
   /*Add hidden layer neurons to network*/
-  for (auto n : hids)
+  for (int l = 0; l < no_hid; l++)
   {
-    Vector<double> neurons(n);
-    Vector<double> hidden_bias(n);
-
-    /*construct weight matrices*/
-    Matrix<double> weight(n, bk_n); 
+    Vector<T> neurons(hids[l]);
 
-    weight.randfill();
-    hidden_bias.fill(0);
+    /*weight matrices and biases are views into the parameter buffer, biases start at zero*/
+    Matrix<T> weight = params.weight(l);
 
     network.addMatrix(weight);
     network.addMatrix(neurons);
-    B.push_back(hidden_bias);
-
-    bk_n = neurons.size();
+    B.push_back(params.bias(l));
+    pre_activation.push_back(Vector<T>(hids[l]));
   }
 
   int last_n = output_size; 
 
-  Vector<double> output(last_n);
-  Vector<double> output_bias(last_n); 
-  output_bias.fill(0);
-  B.push_back(output_bias);
+  Vector<T> output(last_n);
+  B.push_back(params.bias(no_hid));
 
-  Matrix<double> weight(last_n, bk_n);
-  weight.randfill();
+  Matrix<T> weight = params.weight(no_hid);
   network.addMatrix(weight);
   network.addMatrix(output);
+  pre_activation.push_back(Vector<T>(last_n));
 
-  act default_fn = {sigmoid, sigmoid_derivative};
-  act output_fn = {linear, linear_derivative};
+  /*error terms in back propagation order, output layer first*/
+  layer_error.clear();
+  layer_error.push_back(Vector<T>(last_n));
+  for (int l = no_hid - 1; l >= 0; l--)
+  {
+    layer_error.push_back(Vector<T>(hids[l]));
+  }
+
+  act default_fn = {&activation_kernels<T>(Activation::sigmoid), "sigmoid"};
+  act output_fn = {&activation_kernels<T>(Activation::linear), "linear"};
 
   for (int i = 0; i < hids.size(); i++)
   {
     A.push_back(default_fn);
   }
   A.push_back(output_fn);
+
+  draw_parameters();
+}
+
+template <typename T>
+void NeuralModel<T>::draw_parameters()
+{
+  for (int l = 0; l <= no_hid; l++)
+  {
+    Matrix<T> weight = params.weight(l);
+    RandomStream stream(seed, l);
+    initialize_weights(weight.getdata(), weight.getCols(), weight.getRows(), initializer, stream);
+    B[l].fill(0);
+  }
+}
+
+template <typename T>
+void NeuralModel<T>::initialize(Initializer kind, std::uint64_t seed)
+{
+  initializer = kind;
+  this->seed = seed;
+  draw_parameters();
+  if (optimizer)
+    optimizer->reset();
+}
+
+template <typename T>
+void NeuralModel<T>::check_affine_layers(Activation output) const
+{
+  int layers = params.layers();
+  for (int l = 0; l < layers; l++)
+  {
+    Activation expected = (l + 1 == layers) ? output : Activation::linear;
+    if (layer_activation(l) != expected)
+    {
+      throw std::invalid_argument("A closed-form fit needs linear activations before the output layer of the model. ");
+    }
+    if (l > 0 && params.shape()[l] != params.shape()[l + 1])
+    {
+      throw std::invalid_argument("A closed-form fit needs the layers after the first one to be square. ");
+    }
+  }
 }
 
-void NeuralModel::forward_propagation(const Vector<double> &input)
+template <typename T>
+double NeuralModel<T>::load_linear_solution(const Matrix<double> &solution, const Matrix<T> &in, const Matrix<T> &out)
 {
+  Matrix<T> weight = params.weight(0);
+  Vector<T> bias = params.bias(0);
+  int features = weight.getCols();
+  for (int o = 0; o < weight.getRows(); o++)
+  {
+    for (int i = 0; i < features; i++)
+      weight(o, i) = static_cast<T>(solution(i, o));
+    bias[o] = static_cast<T>(solution(features, o));
+  }
 
-  int layer = 0;
+  /*a stack of linear layers is one affine map, the later layers pass it through*/
+  for (int l = 1; l < params.layers(); l++)
+  {
+    Matrix<T> identity = params.weight(l);
+    identity.fill(0);
+    for (int i = 0; i < identity.getRows(); i++)
+      identity(i, i) = 1;
+    params.bias(l).fill(0);
+  }
+
+  /*same loss as an epoch of train(), half the squared error per sample*/
+  double error = 0;
+  for (int i = 0; i < in.getRows(); i++)
+  {
+    forward_propagation(in.row(i));
+    VectorView<const T> prediction = network[network.size() - 1].col(0);
+    error += total_error<T>(out.row(i), prediction);
+  }
+  error = error / in.getRows();
+  std::cout<<"Fit----- Error: "<<error<<std::endl;
+
+  return error;
+}
+
+template <typename T>
+void NeuralModel<T>::forward_propagation(VectorView<const T> input)
+{
+  int layer = 1;
   int i = 0;
-  network[layer] = input;
 
-  /* Calculate output of hidden layer */
+  /*the input is read in place, network[0] is not written*/
+  layer_input = input;
+  VectorView<const T> hidden_layer = input;
+
+  /* Calculate output of hidden layer, z = W * h + b in one pass, then act(z) into the layer;
+     both are kept for back propagation */
   for (i = 0; i < no_hid; i++)
   {
-    auto hidden_layer = convert_col(network[layer++], 0);
-    auto p = (network[layer++] * hidden_layer) + B[i];
+    Matrix<T> &weight = network[layer++];
+    VectorView<T> neurons = network[layer++].col(0);
+    Vector<T> &z = pre_activation[i];
 
-    network[layer] = vector_act(p, A[i].activation);
+    assign(VectorView<T>(z), weight * hidden_layer + B[i]);
+    A[i].kernels->activate(z.size(), z.getdata(), neurons.data());
+    hidden_layer = neurons;
   }
 
   /*Calculate final output  no sigmoid*/ 
-  auto hidden_layer = convert_col(network[layer++], 0);
-  auto p = (network[layer++] * hidden_layer); 
-
-  network[layer] = vector_act(p, A[no_hid].activation);
+  Matrix<T> &weight = network[layer++];
+  VectorView<T> output = network[layer].col(0);
+  Vector<T> &z = pre_activation[no_hid];
+  assign(VectorView<T>(z), weight * hidden_layer);
+  A[no_hid].kernels->activate(z.size(), z.getdata(), output.data());
 }
 
 
-Vector<double> NeuralModel::NNPredicted()
+template <typename T>
+Vector<T> NeuralModel<T>::NNPredicted()
 {
   int count = network.size() - 1;
-  Vector<double> output = convert_col(network[count], 0);
+  Vector<T> output = convert_col(network[count], 0);
 
   return (output);
 }
 
-void NeuralModel::back_propagation(const Vector<double> &expected_output)
+template <typename T>
+VectorView<const T> NeuralModel<T>::NNOutput()
 {
+  return network[network.size() - 1].col(0);
+}
 
-  std::vector<Vector<double>> error;
+template <typename T>
+T NeuralModel<T>::back_propagation(VectorView<const T> expected_output)
+{
+  /*error terms of every layer go into the buffers sized by NNBuild, output layer first*/
+  std::vector<Vector<T>> &error = layer_error;
   int count = network.size() - 1;
 
-  /*Extract Value of output from tensor network*/ 
-  Vector<double> output = convert_col(network[count], 0);
+  /*View the output of the tensor network*/ 
+  VectorView<const T> output = network[count].col(0);
 
-  /* calculate error for the output layer*/
-  Vector<double> output_error(output.size());
-  for (int i = 0; i < output.size(); i++)
-  {
-    double derr = expected_output[i] - output[i];
-    output_error[i] = derr * A[no_hid].derivative(output[i]);
-  }
-  error.push_back(output_error);
+  /* calculate error for the output layer, the loss of the sample comes out of the same pass*/
+  Vector<T> &output_error = error[0];
+  T loss = output_loss(expected_output, output, output_error.getdata());
+  A[no_hid].kernels->gradient(output.size(), pre_activation[no_hid].getdata(), output.data(),
+                              output_error.getdata(), output_error.getdata());
 
   /*calculate error for the hidden layer*/
   for (int hid = 0; hid < no_hid; hid++)
   {
-    Matrix<double> h_weight = network[--count].transpose();
-    Vector<double> hidden_n = convert_col(network[--count], 0);
-    Vector<double> h_error(hidden_n.size());
-
-    h_error = h_weight * error[hid];
-
-    for (int i = 0; i < h_error.size(); i++)
-      h_error[i] = h_error[i] * A[hid].derivative(hidden_n[i]);
+    /*W^T * error is read straight from W, the transpose is never formed*/
+    MatrixView<const T> h_weight = network[--count].view();
+    VectorView<const T> hidden_n = network[--count].col(0);
+    Vector<T> &h_error = error[hid + 1];
+
+    if (enable_parallel)
+      matrix_transpose_vector_multiply(h_weight, VectorView<const T>(error[hid]), VectorView<T>(h_error),
+                                       ThreadPool::instance().size());
+    else
+      matrix_transpose_vector_multiply(h_weight, VectorView<const T>(error[hid]), VectorView<T>(h_error));
 
-    error.push_back(h_error);
+    /*f'(z) of hidden layer l from the values cached by the forward pass*/
+    int l = no_hid - 1 - hid;
+    A[l].kernels->gradient(h_error.size(), pre_activation[l].getdata(), hidden_n.data(),
+                           h_error.getdata(), h_error.getdata());
   }
 
   count = network.size() - 1;
   int iter = no_hid + 1;
 
-  /* Update weights for layers*/
+  /* Update weights for layers, one fused axpy per row*/
   for (int layer = 0; layer < iter; layer++)
   {
-    Matrix<double> &h_weight = network[--count];
-    Vector<double> hidden_n = convert_col(network[--count], 0);
+    Matrix<T> &h_weight = network[--count];
+    --count;
+    VectorView<const T> hidden_n = (count == 0) ? layer_input : network[count].col(0);
+    const Vector<T> &layer_err = error[layer];
+    T rate = static_cast<T>(learning_rate);
 
     for (int i = 0; i < h_weight.getRows(); i++)
     {
-      for (int j = 0; j < h_weight.getCols(); j++)
+      add_assign(h_weight.row(i), (rate * layer_err[i]) * hidden_n);
+    }
+
+    /*Update Bias*/ 
+    add_assign(VectorView<T>(B[no_hid - layer]), rate * VectorView<const T>(layer_err));
+  }
+
+  return loss;
+}
+
+template <typename T>
+void NeuralModel<T>::setBatchSize(int size)
+{
+  if (size < 1)
+  {
+    throw std::invalid_argument("The batch size must be at least one sample. ");
+  }
+  batch_size = size;
+}
+
+template <typename T>
+void NeuralModel<T>::setOptimizer(std::shared_ptr<Optimizer<T>> opt)
+{
+  optimizer = opt;
+  if (optimizer)
+    optimizer->reset();
+}
+
+template <typename T>
+void NeuralModel<T>::reserve_batch(batch_workspace &ws, int rows)
+{
+  if (!ws.layers.empty() && ws.layers[0].getRows() >= rows)
+    return;
+
+  ws.pre.clear();
+  ws.layers.clear();
+  ws.error.clear();
+  for (int l = 0; l <= no_hid; l++)
+  {
+    int units = network[2 * l + 1].getRows();
+    ws.pre.push_back(Matrix<T>(rows, units));
+    ws.layers.push_back(Matrix<T>(rows, units));
+    ws.error.push_back(Matrix<T>(rows, units));
+  }
+}
+
+template <typename T>
+void NeuralModel<T>::reserve_replicas(int shards, int rows, bool with_gradients)
+{
+  if (static_cast<int>(replicas.size()) < shards)
+  {
+    replicas.resize(shards);
+    replica_error.resize(shards);
+  }
+
+  for (int w = 0; w < shards; w++)
+    reserve_batch(replicas[w], rows);
+
+  while (with_gradients && static_cast<int>(gradients.size()) < shards)
+    gradients.push_back(ParameterBuffer<T>(params.shape()));
+}
+
+template <typename T>
+void NeuralModel<T>::forward_batch(batch_workspace &ws, MatrixView<const T> input)
+{
+  if (input.getCols() != network[1].getCols())
+  {
+    throw std::invalid_argument("The number of batch columns must be equal to the network input. ");
+  }
+
+  int n = input.getRows();
+  reserve_batch(ws, n);
+  ws.input = input;
+  ws.rows = n;
+
+  MatrixView<const T> hidden = input;
+
+  for (int l = 0; l <= no_hid; l++)
+  {
+    Matrix<T> &weight = network[2 * l + 1];
+    MatrixView<T> z = ws.pre[l].block(0, 0, n, weight.getRows());
+    MatrixView<T> neurons = ws.layers[l].block(0, 0, n, weight.getRows());
+
+    /*Z = H * W^T for the whole batch in one GEMM, W^T is read through its strides*/
+    if (n == 1)
+      matrix_vector_multiply(weight.view(), hidden.row(0), z.row(0));
+    else
+      gemm(n, weight.getRows(), weight.getCols(), T(1),
+           hidden.data(), hidden.rowStride(), hidden.colStride(),
+           weight.getdata(), 1, weight.getCols(),
+           T(0), z.data(), z.rowStride(), 1);
+
+    /*Z + b row by row, the output layer has no bias*/
+    if (l < no_hid)
+    {
+      for (int r = 0; r < n; r++)
+        assign(z.row(r), VectorView<const T>(z.row(r)) + B[l]);
+    }
+
+    /*act(Z) over the whole block, the workspace rows are packed; softmax normalizes each row*/
+    if (A[l].kernels->kind == Activation::softmax)
+    {
+      for (int r = 0; r < n; r++)
+        A[l].kernels->activate(z.getCols(), z.row(r).data(), neurons.row(r).data());
+    }
+    else
+      A[l].kernels->activate(n * z.getCols(), z.data(), neurons.data());
+
+    hidden = neurons;
+  }
+}
+
+template <typename T>
+void NeuralModel<T>::forward_batch(MatrixView<const T> input)
+{
+  forward_batch(batch, input);
+}
+
+template <typename T>
+MatrixView<const T> NeuralModel<T>::NNBatchOutput()
+{
+  return batch.layers[no_hid].block(0, 0, batch.rows, batch.layers[no_hid].getCols());
+}
+
+template <typename T>
+double NeuralModel<T>::batch_errors(batch_workspace &ws, MatrixView<const T> expected_output)
+{
+  int n = ws.rows;
+  MatrixView<const T> output = ws.layers[no_hid].block(0, 0, n, ws.layers[no_hid].getCols());
+
+  if (expected_output.getRows() != n || expected_output.getCols() != output.getCols())
+  {
+    throw std::invalid_argument("The expected batch must have the shape of the network output. ");
+  }
+
+  /* calculate error for the output layer*/
+  MatrixView<T> output_error = ws.error[no_hid].block(0, 0, n, output.getCols());
+  double loss = 0;
+  for (int r = 0; r < n; r++)
+  {
+    loss += output_loss(expected_output.row(r), output.row(r), output_error.row(r).data());
+  }
+  A[no_hid].kernels->gradient(n * output.getCols(), ws.pre[no_hid].getdata(), output.data(),
+                              output_error.data(), output_error.data());
+
+  /*calculate error for the hidden layers, D_l = (D_l+1 * W_l+1) .* f'(Z_l)*/
+  for (int hid = 0; hid < no_hid; hid++)
+  {
+    int l = no_hid - 1 - hid;
+    Matrix<T> &weight = network[2 * l + 3];
+    MatrixView<const T> next_error = ws.error[l + 1].block(0, 0, n, weight.getRows());
+    MatrixView<const T> hidden_n = ws.layers[l].block(0, 0, n, weight.getCols());
+    MatrixView<T> h_error = ws.error[l].block(0, 0, n, weight.getCols());
+
+    if (n == 1)
+      matrix_transpose_vector_multiply(weight.view(), next_error.row(0), h_error.row(0));
+    else
+      gemm(n, weight.getCols(), weight.getRows(), T(1),
+           next_error.data(), next_error.rowStride(), 1,
+           weight.getdata(), weight.getCols(), 1,
+           T(0), h_error.data(), h_error.rowStride(), 1);
+
+    A[l].kernels->gradient(n * h_error.getCols(), ws.pre[l].getdata(), hidden_n.data(),
+                           h_error.data(), h_error.data());
+  }
+
+  return loss;
+}
+
+template <typename T>
+void NeuralModel<T>::batch_gradient(batch_workspace &ws, ParameterBuffer<T> &target, T scale, T beta)
+{
+  int n = ws.rows;
+
+  for (int l = 0; l <= no_hid; l++)
+  {
+    Matrix<T> weight = target.weight(l);
+    VectorView<T> bias = target.bias(l);
+    MatrixView<const T> layer_err = ws.error[l].block(0, 0, n, weight.getRows());
+    MatrixView<const T> hidden_n = (l == 0) ? ws.input : ws.layers[l - 1].block(0, 0, n, weight.getCols());
+
+    /*W = beta * W + scale * D^T * H*/
+    gemm(weight.getRows(), weight.getCols(), n, scale,
+         layer_err.data(), 1, layer_err.rowStride(),
+         hidden_n.data(), hidden_n.rowStride(), hidden_n.colStride(),
+         beta, weight.getdata(), weight.getCols(), 1);
+
+    /*b = beta * b + scale * column sums of D*/
+    if (beta == T(0))
+      std::fill(bias.data(), bias.data() + bias.size(), T(0));
+
+    for (int r = 0; r < n; r++)
+    {
+      add_assign(bias, scale * layer_err.row(r));
+    }
+  }
+}
+
+template <typename T>
+double NeuralModel<T>::back_propagation_batch(MatrixView<const T> expected_output)
+{
+  double loss = batch_errors(batch, expected_output);
+
+  /* Update weights and biases in place with the gradient averaged over the batch*/
+  batch_gradient(batch, params, static_cast<T>(learning_rate / batch.rows), T(1));
+  return loss;
+}
+
+template <typename T>
+double NeuralModel<T>::train_rows(batch_workspace &ws, const Matrix<T> &in, const Matrix<T> &out, int first, int last)
+{
+  double error = 0;
+
+  for (int start = first; start < last; start += batch_size)
+  {
+    int n = std::min(batch_size, last - start);
+    error += batch_step(ws, in.block(start, 0, n, in.getCols()), out.block(start, 0, n, out.getCols()));
+  }
+
+  return error;
+}
+
+template <typename T>
+double NeuralModel<T>::batch_step(batch_workspace &ws, MatrixView<const T> input, MatrixView<const T> target)
+{
+  int n = input.getRows();
+
+  /*the loss is taken from the outputs before this step's update, as in the sample by sample loop*/
+  forward_batch(ws, input);
+  double error = batch_errors(ws, target);
+
+  if (optimizer)
+  {
+    /*the error terms point downhill, the loss gradient is their negated average*/
+    batch_gradient(ws, gradient, static_cast<T>(-1.0 / n), T(0));
+    optimizer->step(params.view(), gradient.view());
+  }
+  else
+    batch_gradient(ws, params, static_cast<T>(learning_rate / n), T(1));
+
+  return error;
+}
+
+template <typename T>
+int NeuralModel<T>::gather_rows(batch_workspace &ws, const Matrix<T> &in, const Matrix<T> &out, const std::vector<int> &rows, std::size_t first, int count)
+{
+  if (in.getRows() != out.getRows())
+  {
+    throw std::invalid_argument("The input and output matrices must have the same number of rows. ");
+  }
+
+  int n = static_cast<int>(std::min<std::size_t>(count, rows.size() - first));
+  if (ws.staged_input.getRows() < n || ws.staged_input.getCols() != in.getCols() || ws.staged_output.getCols() != out.getCols())
+  {
+    ws.staged_input = Matrix<T>(std::max(n, ws.staged_input.getRows()), in.getCols());
+    ws.staged_output = Matrix<T>(std::max(n, ws.staged_output.getRows()), out.getCols());
+  }
+
+  for (int r = 0; r < n; r++)
+  {
+    int row = rows[first + r];
+    if (row < 0 || row >= in.getRows())
+    {
+      throw std::invalid_argument("A row index is outside the data. ");
+    }
+    std::copy(in[row], in[row] + in.getCols(), ws.staged_input[r]);
+    std::copy(out[row], out[row] + out.getCols(), ws.staged_output[r]);
+  }
+
+  return n;
+}
+
+template <typename T>
+double NeuralModel<T>::train_indexed(batch_workspace &ws, const Matrix<T> &in, const Matrix<T> &out, const std::vector<int> &rows, std::size_t first, std::size_t last)
+{
+  double error = 0;
+
+  for (std::size_t start = first; start < last; start += batch_size)
+  {
+    int n = gather_rows(ws, in, out, rows, start, static_cast<int>(std::min<std::size_t>(batch_size, last - start)));
+    error += batch_step(ws, ws.staged_input.block(0, 0, n, in.getCols()), ws.staged_output.block(0, 0, n, out.getCols()));
+  }
+
+  return error;
+}
+
+template <typename T>
+double NeuralModel<T>::train_subset(const Matrix<T> &in, const Matrix<T> &out, const std::vector<int> &rows)
+{
+  if (rows.empty())
+    return 0;
+
+  double error = 0;
+  if (!batched_training())
+  {
+    for (int row : rows)
+    {
+      if (row < 0 || row >= in.getRows() || row >= out.getRows())
       {
-        double delta_weight = learning_rate * error[layer][i] * hidden_n[j];
-        h_weight[i][j] += delta_weight;
+        throw std::invalid_argument("A row index is outside the data. ");
       }
+      forward_propagation(in.row(row));
+      error += back_propagation(out.row(row));
+    }
+    return error / rows.size();
+  }
+
+  /*as train_batches, with every mini-batch or shard gathered from the indexed rows first*/
+  int count = static_cast<int>(rows.size());
+  int threads = ThreadPool::instance().size();
 
-      /*Update Bias*/ 
-      B[no_hid - layer][i] += learning_rate * error[layer][i];
+  switch (training_mode)
+  {
+  case TrainingMode::synchronous:
+  {
+    int batch_rows = std::min(batch_size, count);
+    reserve_replicas(std::min(batch_rows, threads), (batch_rows + threads - 1) / threads, true);
+
+    for (int start = 0; start < count; start += batch_size)
+    {
+      int n = gather_rows(batch, in, out, rows, start, batch_size);
+      error += synchronous_step(batch.staged_input, batch.staged_output, 0, n);
+    }
+    break;
+  }
+
+  case TrainingMode::hogwild:
+  {
+    if (optimizer)
+    {
+      throw std::invalid_argument("Hogwild training only supports the plain SGD update. ");
     }
+
+    /*every thread owns a contiguous part of the index list and gathers its own batches*/
+    int shards = std::max(1, std::min(count, threads));
+    reserve_replicas(shards, std::min(batch_size, count), false);
+
+    parallel_for(0, shards, 1, [&](std::size_t w, std::size_t)
+                 {
+                   std::size_t first = w * rows.size() / shards;
+                   std::size_t last = (w + 1) * rows.size() / shards;
+                   replica_error[w] = train_indexed(replicas[w], in, out, rows, first, last);
+                 });
+
+    for (int w = 0; w < shards; w++)
+      error += replica_error[w];
+    break;
+  }
+
+  default:
+    if (optimizer && gradient.size() != params.size())
+      gradient = ParameterBuffer<T>(params.shape());
+    error = train_indexed(batch, in, out, rows, 0, rows.size());
+    break;
   }
 
-}
\ No newline at end of file
+  return error / rows.size();
+}
+
+template <typename T>
+double NeuralModel<T>::synchronous_step(const Matrix<T> &in, const Matrix<T> &out, int first, int n)
+{
+  int shards = std::min<int>(n, ThreadPool::instance().size());
+  T scale = optimizer ? static_cast<T>(-1.0 / n) : static_cast<T>(learning_rate / n);
+
+  /*every shard computes its share of the batch gradient into its own buffer*/
+  parallel_for(0, shards, 1, [&](std::size_t w, std::size_t)
+               {
+                 int begin = first + static_cast<int>(w * n / shards);
+                 int end = first + static_cast<int>((w + 1) * n / shards);
+                 batch_workspace &ws = replicas[w];
+                 MatrixView<const T> target = out.block(begin, 0, end - begin, out.getCols());
+
+                 forward_batch(ws, in.block(begin, 0, end - begin, in.getCols()));
+                 replica_error[w] = batch_errors(ws, target);
+                 batch_gradient(ws, gradients[w], scale, T(0));
+               });
+
+  /*reduce the shard gradients, one linear sweep per shard over each slice; without an
+    optimizer they are already scaled steps and go straight into the parameters*/
+  T *sum = optimizer ? gradients[0].data() : params.data();
+  int first_shard = optimizer ? 1 : 0;
+  std::size_t size = params.size();
+  std::size_t grain = std::max<std::size_t>(vadd_min_chunk, size / ThreadPool::instance().size() + 1);
+  parallel_for(0, size, grain, [&](std::size_t begin, std::size_t end)
+               {
+                 for (int w = first_shard; w < shards; w++)
+                 {
+                   simd::vadd(sum + begin, gradients[w].data() + begin, sum + begin, static_cast<int>(end - begin));
+                 }
+               });
+
+  if (optimizer)
+    optimizer->step(params.view(), gradients[0].view());
+
+  double error = 0;
+  for (int w = 0; w < shards; w++)
+    error += replica_error[w];
+  return error;
+}
+
+template <typename T>
+double NeuralModel<T>::train_batches(const Matrix<T> &in, const Matrix<T> &out)
+{
+  double error = 0;
+  int rows = in.getRows();
+  int threads = ThreadPool::instance().size();
+
+  switch (training_mode)
+  {
+  case TrainingMode::synchronous:
+  {
+    int batch_rows = std::min(batch_size, rows);
+    reserve_replicas(std::min(batch_rows, threads), (batch_rows + threads - 1) / threads, true);
+
+    for (int start = 0; start < rows; start += batch_size)
+    {
+      error += synchronous_step(in, out, start, std::min(batch_size, rows - start));
+    }
+    break;
+  }
+
+  case TrainingMode::hogwild:
+  {
+    if (optimizer)
+    {
+      throw std::invalid_argument("Hogwild training only supports the plain SGD update. ");
+    }
+
+    /*every thread owns a contiguous shard of the rows and writes the shared weights directly*/
+    int shards = std::max(1, std::min(rows, threads));
+    reserve_replicas(shards, std::min(batch_size, rows), false);
+
+    parallel_for(0, shards, 1, [&](std::size_t w, std::size_t)
+                 {
+                   int first = static_cast<int>(w * rows / shards);
+                   int last = static_cast<int>((w + 1) * rows / shards);
+                   replica_error[w] = train_rows(replicas[w], in, out, first, last);
+                 });
+
+    for (int w = 0; w < shards; w++)
+      error += replica_error[w];
+    break;
+  }
+
+  default:
+    reserve_batch(batch, std::min(batch_size, rows));
+    if (optimizer && gradient.size() != params.size())
+      gradient = ParameterBuffer<T>(params.shape());
+    error = train_rows(batch, in, out, 0, rows);
+    break;
+  }
+
+  return error;
+}
+
+template <typename T>
+T NeuralModel<T>::output_loss(VectorView<const T> expected, VectorView<const T> output, T *error) const
+{
+  if (expected.size() != output.size())
+  {
+    throw std::invalid_argument("The expected output must have the size of the network output. ");
+  }
+
+  /*the loss terms are read off the error while it is written*/
+  T loss = 0;
+  if (A[no_hid].kernels->kind == Activation::softmax)
+  {
+    for (int i = 0; i < output.size(); i++)
+    {
+      error[i] = expected[i] - output[i];
+      if (expected[i] != T(0))
+        loss -= expected[i] * std::log(std::max(output[i], std::numeric_limits<T>::min()));
+    }
+  }
+  else
+  {
+    for (int i = 0; i < output.size(); i++)
+    {
+      T e = expected[i] - output[i];
+      error[i] = e;
+      loss += T(0.5) * e * e;
+    }
+  }
+  return loss;
+}
+
+template <typename T>
+double NeuralModel<T>::accuracy(const Matrix<T> &in, const Matrix<T> &expected)
+{
+  if (in.getRows() != expected.getRows() || expected.getCols() != network[network.size() - 1].getRows())
+  {
+    throw std::invalid_argument("The expected matrix must have one output row per input row. ");
+  }
+
+  int rows = in.getRows();
+  if (rows == 0)
+    return 0;
+
+  /*forward passes reuse the training workspace, rows go through it in GEMM sized chunks*/
+  int chunk = std::max(batch_size, evaluation_rows);
+  long correct = 0;
+  for (int start = 0; start < rows; start += chunk)
+  {
+    int n = std::min(chunk, rows - start);
+    forward_batch(batch, in.block(start, 0, n, in.getCols()));
+    correct += std::lround(n * ::accuracy(NNBatchOutput(), expected.block(start, 0, n, expected.getCols())));
+  }
+
+  return static_cast<double>(correct) / rows;
+}
+
+template <typename T>
+double NeuralModel<T>::loss(const Matrix<T> &in, const Matrix<T> &expected)
+{
+  if (in.getRows() != expected.getRows() || expected.getCols() != network[network.size() - 1].getRows())
+  {
+    throw std::invalid_argument("The expected matrix must have one output row per input row. ");
+  }
+
+  int rows = in.getRows();
+  if (rows == 0)
+    return 0;
+
+  /*same chunked forward passes as accuracy, the error rows of the workspace take the output error*/
+  int chunk = std::max(batch_size, evaluation_rows);
+  double total = 0;
+  for (int start = 0; start < rows; start += chunk)
+  {
+    int n = std::min(chunk, rows - start);
+    forward_batch(batch, in.block(start, 0, n, in.getCols()));
+
+    MatrixView<const T> output = NNBatchOutput();
+    MatrixView<T> error = batch.error[no_hid].block(0, 0, n, output.getCols());
+    for (int r = 0; r < n; r++)
+    {
+      total += output_loss(expected.row(start + r), output.row(r), error.row(r).data());
+    }
+  }
+
+  return total / rows;
+}
+
+template <typename T>
+double NeuralModel<T>::loss(const Matrix<T> &in, const Matrix<T> &expected, const std::vector<int> &rows)
+{
+  if (expected.getCols() != network[network.size() - 1].getRows())
+  {
+    throw std::invalid_argument("The expected matrix must have one output row per input row. ");
+  }
+  if (rows.empty())
+    return 0;
+
+  int chunk = std::max(batch_size, evaluation_rows);
+  double total = 0;
+  for (std::size_t start = 0; start < rows.size(); start += chunk)
+  {
+    int n = gather_rows(batch, in, expected, rows, start, chunk);
+    forward_batch(batch, batch.staged_input.block(0, 0, n, in.getCols()));
+
+    MatrixView<const T> output = NNBatchOutput();
+    MatrixView<T> error = batch.error[no_hid].block(0, 0, n, output.getCols());
+    for (int r = 0; r < n; r++)
+    {
+      total += output_loss(batch.staged_output.row(r), output.row(r), error.row(r).data());
+    }
+  }
+
+  return total / rows.size();
+}
+
+template <typename T>
+double NeuralModel<T>::accuracy(const Matrix<T> &in, const Matrix<T> &expected, const std::vector<int> &rows)
+{
+  if (expected.getCols() != network[network.size() - 1].getRows())
+  {
+    throw std::invalid_argument("The expected matrix must have one output row per input row. ");
+  }
+  if (rows.empty())
+    return 0;
+
+  int chunk = std::max(batch_size, evaluation_rows);
+  long correct = 0;
+  for (std::size_t start = 0; start < rows.size(); start += chunk)
+  {
+    int n = gather_rows(batch, in, expected, rows, start, chunk);
+    forward_batch(batch, batch.staged_input.block(0, 0, n, in.getCols()));
+    correct += std::lround(n * ::accuracy<T>(NNBatchOutput(), batch.staged_output.block(0, 0, n, expected.getCols())));
+  }
+
+  return static_cast<double>(correct) / rows.size();
+}
+
+template class NeuralModel<float>;
+template class NeuralModel<double>;
@@ -0,0 +1,152 @@
+#include "optimizer.h"
+
+#include <config.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "parallel.h"
+#include "simd.h"
+#include "threadpool.h"
+
+template <typename T>
+void Optimizer<T>::step(VectorView<T> params, VectorView<const T> gradient)
+{
+    if (params.size() != gradient.size() || !params.contiguous() || !gradient.contiguous())
+    {
+        throw std::invalid_argument("The optimizer needs contiguous parameter and gradient buffers of equal size. ");
+    }
+
+    std::size_t n = params.size();
+    if (n != size)
+    {
+        resize(n);
+        size = n;
+        t = 0;
+    }
+
+    t++;
+    prepare();
+
+    T *p = params.data();
+    const T *g = gradient.data();
+    auto body = [&](std::size_t first, std::size_t last)
+    {
+        update(first, static_cast<int>(last - first), p + first, g + first);
+    };
+
+    if (enable_parallel && n >= vadd_parallel_threshold)
+        parallel_for(0, n, std::max(vadd_min_chunk, n / ThreadPool::instance().size() + 1), body);
+    else
+        body(0, n);
+}
+
+template <typename T>
+void Optimizer<T>::reset()
+{
+    t = 0;
+    size = 0;
+}
+
+template <typename T>
+SGD<T>::SGD(double rate) : rate(static_cast<T>(rate))
+{
+}
+
+template <typename T>
+void SGD<T>::update(std::size_t /*offset*/, int n, T *params, const T *gradient)
+{
+    for (int i = 0; i < n; i++)
+    {
+        params[i] -= rate * gradient[i];
+    }
+}
+
+template <typename T>
+Momentum<T>::Momentum(double rate, double mu) : rate(static_cast<T>(rate)), mu(static_cast<T>(mu))
+{
+}
+
+template <typename T>
+void Momentum<T>::resize(std::size_t n)
+{
+    velocity.assign(n, T(0));
+}
+
+template <typename T>
+void Momentum<T>::update(std::size_t offset, int n, T *params, const T *gradient)
+{
+    simd::momentum_step(n, params, gradient, velocity.data() + offset, mu, rate, T(1), T(0));
+}
+
+template <typename T>
+Nesterov<T>::Nesterov(double rate, double mu) : Momentum<T>(rate, mu)
+{
+}
+
+template <typename T>
+void Nesterov<T>::update(std::size_t offset, int n, T *params, const T *gradient)
+{
+    /*look ahead along the new velocity: p += mu * v - rate * g*/
+    simd::momentum_step(n, params, gradient, this->velocity.data() + offset, this->mu, this->rate, this->mu, -this->rate);
+}
+
+template <typename T>
+RMSProp<T>::RMSProp(double rate, double decay, double eps)
+    : rate(static_cast<T>(rate)), decay(static_cast<T>(decay)), eps(static_cast<T>(eps))
+{
+}
+
+template <typename T>
+void RMSProp<T>::resize(std::size_t n)
+{
+    square.assign(n, T(0));
+}
+
+template <typename T>
+void RMSProp<T>::update(std::size_t offset, int n, T *params, const T *gradient)
+{
+    simd::adaptive_step(n, params, gradient, static_cast<T *>(nullptr), square.data() + offset, T(0), decay, rate, eps);
+}
+
+template <typename T>
+Adam<T>::Adam(double rate, double beta1, double beta2, double eps)
+    : rate(rate), beta1(beta1), beta2(beta2), eps(eps)
+{
+}
+
+template <typename T>
+void Adam<T>::prepare()
+{
+    /*rate * m_hat / (sqrt(v_hat) + eps) rewritten on the raw moments*/
+    double correction1 = 1 - std::pow(beta1, static_cast<double>(this->t));
+    double correction2 = std::sqrt(1 - std::pow(beta2, static_cast<double>(this->t)));
+    step_rate = static_cast<T>(rate * correction2 / correction1);
+    step_eps = static_cast<T>(eps * correction2);
+}
+
+template <typename T>
+void Adam<T>::resize(std::size_t n)
+{
+    first.assign(n, T(0));
+    second.assign(n, T(0));
+}
+
+template <typename T>
+void Adam<T>::update(std::size_t offset, int n, T *params, const T *gradient)
+{
+    simd::adaptive_step(n, params, gradient, first.data() + offset, second.data() + offset,
+                        static_cast<T>(beta1), static_cast<T>(beta2), step_rate, step_eps);
+}
+
+template class Optimizer<float>;
+template class Optimizer<double>;
+template class SGD<float>;
+template class SGD<double>;
+template class Momentum<float>;
+template class Momentum<double>;
+template class Nesterov<float>;
+template class Nesterov<double>;
+template class RMSProp<float>;
+template class RMSProp<double>;
+template class Adam<float>;
+template class Adam<double>;
@@ -2,10 +2,11 @@
 
     
 
-    SimpleNeuralNetwork:: SimpleNeuralNetwork(Matrix<double> &rin,
-                 Matrix<double> &rout,
+    template <typename T>
+    SimpleNeuralNetwork<T>:: SimpleNeuralNetwork(Matrix<T> &rin,
+                 Matrix<T> &rout,
                  std::initializer_list<int> rhidden_neurons,
-                 double rrate): NeuralModel(rin, rout, rhidden_neurons, rrate), input(rin) , output(rout)
+                 double rrate): NeuralModel<T>(rin, rout, rhidden_neurons, rrate), input(rin) , output(rout)
                  {
 
 
@@ -20,43 +21,72 @@
 
                  }
 
-    SimpleNeuralNetwork::SimpleNeuralNetwork(): NeuralModel()
+    template <typename T>
+    SimpleNeuralNetwork<T>:: SimpleNeuralNetwork(Matrix<T> &rin,
+                 Matrix<T> &rout,
+                 const std::vector<int> &rhidden_neurons,
+                 double rrate): NeuralModel<T>(rin, rout, rhidden_neurons, rrate), input(rin) , output(rout), H(rhidden_neurons)
+                 {
+                    num_inputs = rin.getCols();
+                    num_hidden = rhidden_neurons.size();
+                    num_outputs = rout.getCols();
+                    learning_rate = rrate;
+                 }
+
+    template <typename T>
+    SimpleNeuralNetwork<T>::SimpleNeuralNetwork(): NeuralModel<T>()
          {
 
          }
                  
 
     
-    void SimpleNeuralNetwork::train(int epochs){
+    template <typename T>
+    void SimpleNeuralNetwork<T>::train(int epochs){
          double error;
 
          for (int count = 0; count < epochs; count++)
          {
-           error = 0;
+           error = train_epoch();
+           std::cout<<"Epoch----- "<< count << " Error: "<<error<<std::endl;
+         }
+ }
+
+    template <typename T>
+    double SimpleNeuralNetwork<T>::train_epoch(){
+         double error = 0;
+
+         if (sampler)
+           return NeuralModel<T>::train_subset(input, output, sampler->next());
+
+         if (NeuralModel<T>::batched_training())
+           error = NeuralModel<T>::train_batches(input, output);
+         else
+         {
            for(int i = 0; i < input.getRows(); i++)
             {
-              auto in = convert_row(input, i);
-              auto target = convert_row(output, i);
-
-              NeuralModel::forward_propagation(in);
-              NeuralModel::back_propagation(target);
+              VectorView<const T> in = input.row(i);
+              VectorView<const T> target = output.row(i);
 
-            error += total_error(target,  NeuralModel::NNPredicted());
+              /*the step runs in the model buffers and returns the loss of the sample*/
+              NeuralModel<T>::forward_propagation(in);
+              error += NeuralModel<T>::back_propagation(target);
           }
-          error = error/input.getRows();
-           std::cout<<"Epoch----- "<< count << " Error: "<<error<<std::endl;
          }
+         return error/input.getRows();
  }
 
 
-    void SimpleNeuralNetwork::save(std::string filename) {
+    template <typename T>
+    void SimpleNeuralNetwork<T>::save(std::string filename) {
 
         std::ofstream file(filename, std::ios::out | std::ios::binary);
         if (!file) {
             std::cerr << "Error: Could not open file " << filename << " for writing\n";
             return;
         }
-        
+
+        write_precision<T>(file);
         file.write(reinterpret_cast<char*>(&num_inputs), sizeof(num_inputs));
         file.write(reinterpret_cast<char*>(&num_hidden), sizeof(num_hidden));
         file.write(reinterpret_cast<char*>(&num_outputs), sizeof(num_outputs));
@@ -67,33 +97,23 @@
             file.write(reinterpret_cast<char*>(&vals), sizeof(vals));
         }
         
-        int network_size = NeuralModel::network.size() - 1;
-        for (int i = 1; i < network_size; i = i+2 )
-        {
-            Matrix<double> weight = NeuralModel::network[i];
-            file.write(reinterpret_cast<char*>(weight.getdata()), weight.size() * sizeof(double)) ;       
-
-        }
-
-                
-        
-        int bias_size = NeuralModel::B.size();
-        for (int i = 0; i < bias_size; i++ )
-        {
-            Vector<double> bias = NeuralModel::B[i];
-            file.write(reinterpret_cast<char*>(bias.getdata()), bias.size() * sizeof(double)) ;       
-
-        }
+        /*weights then biases, written straight from the parameter buffer*/
+        ParameterBuffer<T> &params = NeuralModel<T>::params;
+        file.write(reinterpret_cast<char*>(params.data()), params.size() * sizeof(T));
         file.close();
     }
 
 
-    void SimpleNeuralNetwork::load(std::string filename) {
+    template <typename T>
+    void SimpleNeuralNetwork<T>::load(std::string filename) {
         std::ifstream file(filename, std::ios::in | std::ios::binary);
         if (!file) {
             std::cerr << "Error: Could not open file " << filename << " for reading\n";
             return;
         }
+        if (!check_precision<T>(file, filename))
+            return;
+
         file.read(reinterpret_cast<char*>(&num_inputs), sizeof(num_inputs));
         file.read(reinterpret_cast<char*>(&num_hidden), sizeof(num_hidden));
         file.read(reinterpret_cast<char*>(&num_outputs), sizeof(num_outputs));
@@ -109,40 +129,43 @@
 
         }
 
-        NNBuild(num_inputs, num_outputs, nl);
-
-        int network_size = NeuralModel::network.size() - 1;
-        for (int i = 1; i < network_size; i = i+2 )
-        {
-            Matrix<double> &weight =  NeuralModel::network[i];
-           file.read(reinterpret_cast<char*>(weight.getdata()), weight.size() * sizeof(double));   
-
-        }
-
-        B.clear();
-        for (int i = 0; i < num_hidden; i++ )
-        {
-            Vector<double> bias(nl[i]);
-            file.read(reinterpret_cast<char*>(bias.getdata()), bias.size() * sizeof(double));  
-            B.push_back(bias);
+        H = nl;
+        NeuralModel<T>::NNBuild(num_inputs, num_outputs, nl);
 
+        /*the file holds the parameter buffer as laid out by NNBuild*/
+        ParameterBuffer<T> &params = NeuralModel<T>::params;
+        if (!file || remaining_bytes(file) != params.size() * sizeof(T)) {
+            std::cerr << "Error: " << filename << " does not hold the parameters of its layer sizes\n";
+            return;
         }
+        file.read(reinterpret_cast<char*>(params.data()), params.size() * sizeof(T));
         file.close();
     }
 
 
-    void SimpleNeuralNetwork::configure(std::initializer_list<std::string>& act_value)
+    template <typename T>
+    void SimpleNeuralNetwork<T>::configure(std::initializer_list<std::string>& act_value)
    {
-        NeuralModel::NNConnfigure(act_value);
+        NeuralModel<T>::NNConnfigure(act_value);
    }
 
-    Vector<double> SimpleNeuralNetwork::predict(const Vector<double> &predict){
-        int count = NeuralModel::network.size() - 1;
+    template <typename T>
+    void SimpleNeuralNetwork<T>::configure(const std::vector<std::string>& act_value)
+   {
+        NeuralModel<T>::NNConnfigure(act_value);
+   }
 
-        NeuralModel::forward_propagation(predict);
+    template <typename T>
+    Vector<T> SimpleNeuralNetwork<T>::predict(const Vector<T> &predict){
+        int count = NeuralModel<T>::network.size() - 1;
 
-        Vector<double> output =  convert_col(NeuralModel::network[count], 0);
+        NeuralModel<T>::forward_propagation(predict);
+
+        Vector<T> output =  convert_col(NeuralModel<T>::network[count], 0);
 
     return (output);
 
-  }
\ No newline at end of file
+  }
+
+template class SimpleNeuralNetwork<float>;
+template class SimpleNeuralNetwork<double>;
@@ -0,0 +1,216 @@
+#include "random.h"
+
+#include <config.hpp>
+#include <algorithm>
+#include <cmath>
+#include "simd.h"
+#include "threadpool.h"
+
+using namespace phoenix;
+
+namespace {
+
+/*values converted per chunk of a fill, even so that normal pairs never straddle two chunks*/
+constexpr std::size_t fill_chunk = 256;
+
+/*decorrelates the key of split streams from the key of their parent*/
+constexpr std::uint64_t split_key = 0x9E3779B97F4A7C15ull;
+
+/*words [first, first + n) of a stream, first need not be a multiple of four*/
+void stream_words(std::uint64_t seed, std::uint64_t stream, std::uint64_t first, std::size_t n, std::uint32_t *out)
+{
+    std::uint32_t block[4 * (2 * fill_chunk / 4 + 2)];
+    std::size_t done = 0;
+
+    while (done < n)
+    {
+        std::uint64_t position = first + done;
+        std::size_t offset = static_cast<std::size_t>(position % 4);
+        std::size_t count = std::min<std::size_t>(n - done, 2 * fill_chunk);
+        int blocks = static_cast<int>((offset + count + 3) / 4);
+
+        simd::philox(position / 4, stream, seed, blocks, block);
+        std::copy(block + offset, block + offset + count, out + done);
+        done += count;
+    }
+}
+
+inline float to_unit(std::uint32_t w, float)
+{
+    return static_cast<float>(w >> 8) * 0x1p-24f;
+}
+
+inline double to_unit(const std::uint32_t *w, double)
+{
+    return static_cast<double>((static_cast<std::uint64_t>(w[0]) << 21) ^ (w[1] >> 11)) * 0x1p-53;
+}
+
+inline float to_unit(const std::uint32_t *w, float)
+{
+    return to_unit(w[0], 0.0f);
+}
+
+template <typename T>
+constexpr int words_per_value = sizeof(T) / sizeof(std::uint32_t);
+
+/**
+ * Runs convert(first, count, words, out + first) over chunks of the n values of a fill, on the
+ * thread pool for large fills. Value i always comes from the same words of the stream.
+ */
+template <typename T, typename F>
+void fill_chunks(std::uint64_t seed, std::uint64_t stream, std::uint64_t position, T *out, std::size_t n, F &&convert)
+{
+    std::size_t chunks = (n + fill_chunk - 1) / fill_chunk;
+
+    auto body = [&](std::size_t first_chunk, std::size_t last_chunk)
+    {
+        std::uint32_t words[2 * fill_chunk];
+        for (std::size_t c = first_chunk; c < last_chunk; c++)
+        {
+            std::size_t first = c * fill_chunk;
+            std::size_t count = std::min(fill_chunk, n - first);
+            std::size_t pairs = (count + 1) / 2 * 2;
+            stream_words(seed, stream, position + first * words_per_value<T>, pairs * words_per_value<T>, words);
+            convert(count, words, out + first);
+        }
+    };
+
+    if (enable_parallel && n >= random_parallel_threshold)
+        parallel_for(0, chunks, std::max<std::size_t>(1, chunks / (4 * ThreadPool::instance().size())), body);
+    else
+        body(0, chunks);
+}
+
+template <typename T>
+void uniform_fill(std::uint64_t seed, std::uint64_t stream, std::uint64_t &position, T *out, std::size_t n, T lo, T hi)
+{
+    T range = hi - lo;
+    fill_chunks(seed, stream, position, out, n, [&](std::size_t count, const std::uint32_t *words, T *dst)
+    {
+        for (std::size_t i = 0; i < count; i++)
+            dst[i] = lo + range * to_unit(words + i * words_per_value<T>, T());
+    });
+    position += n * words_per_value<T>;
+}
+
+template <typename T>
+void normal_fill(std::uint64_t seed, std::uint64_t stream, std::uint64_t &position, T *out, std::size_t n, T mean, T stddev)
+{
+    const T two_pi = static_cast<T>(6.283185307179586476925286766559);
+    fill_chunks(seed, stream, position, out, n, [&](std::size_t count, const std::uint32_t *words, T *dst)
+    {
+        /*values 2j and 2j + 1 share a Box-Muller pair, the radius uses 1 - u so the log is finite*/
+        for (std::size_t i = 0; i < count; i += 2)
+        {
+            T u1 = 1 - to_unit(words + i * words_per_value<T>, T());
+            T u2 = to_unit(words + (i + 1) * words_per_value<T>, T());
+            T radius = stddev * std::sqrt(-2 * std::log(u1));
+            dst[i] = mean + radius * std::cos(two_pi * u2);
+            if (i + 1 < count)
+                dst[i + 1] = mean + radius * std::sin(two_pi * u2);
+        }
+    });
+    position += (n + 1) / 2 * 2 * words_per_value<T>;
+}
+
+template <typename T>
+void initialize(T *weights, int fan_in, int fan_out, Initializer kind, RandomStream &stream)
+{
+    std::size_t n = static_cast<std::size_t>(fan_in) * fan_out;
+    double in = std::max(fan_in, 1);
+    double both = std::max(fan_in + fan_out, 1);
+
+    switch (kind)
+    {
+    case Initializer::uniform:
+    {
+        T limit = static_cast<T>(1 / std::sqrt(in));
+        stream.uniform(weights, n, -limit, limit);
+        break;
+    }
+    case Initializer::normal:
+        stream.normal(weights, n, T(0), static_cast<T>(std::sqrt(1 / in)));
+        break;
+    case Initializer::xavier_normal:
+        stream.normal(weights, n, T(0), static_cast<T>(std::sqrt(2 / both)));
+        break;
+    case Initializer::he_uniform:
+    {
+        T limit = static_cast<T>(std::sqrt(6 / in));
+        stream.uniform(weights, n, -limit, limit);
+        break;
+    }
+    case Initializer::he_normal:
+        stream.normal(weights, n, T(0), static_cast<T>(std::sqrt(2 / in)));
+        break;
+    default:
+    {
+        T limit = static_cast<T>(std::sqrt(6 / both));
+        stream.uniform(weights, n, -limit, limit);
+        break;
+    }
+    }
+}
+
+}
+
+RandomStream RandomStream::split(std::uint64_t id) const
+{
+    std::uint32_t block[4];
+    simd::philox(id, stream_, seed_ ^ split_key, 1, block);
+    return RandomStream(seed_, (static_cast<std::uint64_t>(block[1]) << 32) | block[0]);
+}
+
+std::uint32_t RandomStream::next()
+{
+    std::uint32_t block[4];
+    simd::philox(position_ / 4, stream_, seed_, 1, block);
+    return block[position_++ % 4];
+}
+
+void RandomStream::next(std::uint32_t *out, std::size_t n)
+{
+    stream_words(seed_, stream_, position_, n, out);
+    position_ += n;
+}
+
+double RandomStream::uniform()
+{
+    std::uint32_t words[2] = {next(), next()};
+    return to_unit(words, 0.0);
+}
+
+int RandomStream::below(int n)
+{
+    return static_cast<int>((static_cast<std::uint64_t>(next()) * static_cast<std::uint64_t>(n)) >> 32);
+}
+
+void RandomStream::uniform(float *out, std::size_t n, float lo, float hi)
+{
+    uniform_fill(seed_, stream_, position_, out, n, lo, hi);
+}
+
+void RandomStream::uniform(double *out, std::size_t n, double lo, double hi)
+{
+    uniform_fill(seed_, stream_, position_, out, n, lo, hi);
+}
+
+void RandomStream::normal(float *out, std::size_t n, float mean, float stddev)
+{
+    normal_fill(seed_, stream_, position_, out, n, mean, stddev);
+}
+
+void RandomStream::normal(double *out, std::size_t n, double mean, double stddev)
+{
+    normal_fill(seed_, stream_, position_, out, n, mean, stddev);
+}
+
+void initialize_weights(float *weights, int fan_in, int fan_out, Initializer kind, RandomStream &stream)
+{
+    initialize(weights, fan_in, fan_out, kind, stream);
+}
+
+void initialize_weights(double *weights, int fan_in, int fan_out, Initializer kind, RandomStream &stream)
+{
+    initialize(weights, fan_in, fan_out, kind, stream);
+}
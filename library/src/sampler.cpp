@@ -0,0 +1,183 @@
+#include "sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+/*words drawn from a stream at a time*/
+constexpr std::size_t word_chunk = 256;
+
+/*calls f(k, w) for the next n words w of the stream, k = 0 .. n - 1*/
+template <typename F>
+void for_words(RandomStream &stream, std::size_t n, F &&f)
+{
+    std::uint32_t words[word_chunk];
+    for (std::size_t first = 0; first < n; first += word_chunk)
+    {
+        std::size_t count = std::min(word_chunk, n - first);
+        stream.next(words, count);
+        for (std::size_t k = 0; k < count; k++)
+            f(first + k, words[k]);
+    }
+}
+
+/*Fisher-Yates over [first, first + n), position i swaps with one of 0 .. i*/
+void shuffle_range(int *first, std::size_t n, RandomStream &stream)
+{
+    if (n < 2)
+        return;
+    for_words(stream, n - 1, [&](std::size_t k, std::uint32_t w)
+    {
+        std::size_t i = n - 1 - k;
+        std::size_t j = static_cast<std::size_t>((static_cast<std::uint64_t>(w) * (i + 1)) >> 32);
+        std::swap(first[i], first[j]);
+    });
+}
+
+}
+
+void shuffle_indices(std::vector<int> &indices, RandomStream &stream)
+{
+    shuffle_range(indices.data(), indices.size(), stream);
+}
+
+RowSampler::RowSampler(int rows, Sampling kind, std::uint64_t seed)
+    : sampling(kind), seed(seed)
+{
+    if (rows < 0)
+    {
+        throw std::invalid_argument("The number of rows can not be negative. ");
+    }
+    if (kind != Sampling::sequential && kind != Sampling::shuffle)
+    {
+        throw std::invalid_argument("Stratified and weighted sampling need labels or weights. ");
+    }
+    order.resize(rows);
+}
+
+RowSampler::RowSampler(const std::vector<int> &labels, std::uint64_t seed)
+    : sampling(Sampling::stratified), seed(seed), order(labels.size()), keys(labels.size())
+{
+    std::vector<int> distinct(labels);
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+
+    classes.resize(distinct.size());
+    for (std::size_t i = 0; i < labels.size(); i++)
+    {
+        std::size_t c = std::lower_bound(distinct.begin(), distinct.end(), labels[i]) - distinct.begin();
+        classes[c].push_back(static_cast<int>(i));
+    }
+}
+
+RowSampler::RowSampler(const std::vector<double> &weights, int draws, std::uint64_t seed)
+    : sampling(Sampling::weighted), seed(seed)
+{
+    double total = 0;
+    for (double w : weights)
+    {
+        if (!(w >= 0) || !std::isfinite(w))
+        {
+            throw std::invalid_argument("The weights must be finite and non-negative. ");
+        }
+        total += w;
+    }
+    if (!(total > 0))
+    {
+        throw std::invalid_argument("At least one weight must be positive. ");
+    }
+
+    /*Vose's alias table: row i is kept with probability[i], else replaced by alias[i]*/
+    std::size_t n = weights.size();
+    probability.resize(n);
+    alias.resize(n);
+    std::vector<int> small, large;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        probability[i] = weights[i] * n / total;
+        alias[i] = static_cast<int>(i);
+        (probability[i] < 1 ? small : large).push_back(static_cast<int>(i));
+    }
+    while (!small.empty() && !large.empty())
+    {
+        int s = small.back();
+        int l = large.back();
+        small.pop_back();
+        alias[s] = l;
+        probability[l] -= 1 - probability[s];
+        if (probability[l] < 1)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    /*whatever is left is 1 up to rounding*/
+    for (int i : small)
+        probability[i] = 1;
+    for (int i : large)
+        probability[i] = 1;
+
+    order.resize(draws > 0 ? draws : static_cast<int>(n));
+}
+
+const std::vector<int> &RowSampler::epoch(std::uint64_t e)
+{
+    RandomStream stream(seed, e);
+
+    switch (sampling)
+    {
+    case Sampling::sequential:
+        std::iota(order.begin(), order.end(), 0);
+        break;
+
+    case Sampling::shuffle:
+        std::iota(order.begin(), order.end(), 0);
+        shuffle_range(order.data(), order.size(), stream);
+        break;
+
+    case Sampling::stratified:
+    {
+        /*member j of a class of n rows, after shuffling the class, sorts at (j + u) / n*/
+        std::size_t offset = 0;
+        for (const std::vector<int> &members : classes)
+        {
+            int *first = order.data() + offset;
+            std::copy(members.begin(), members.end(), first);
+            shuffle_range(first, members.size(), stream);
+
+            double n = static_cast<double>(members.size());
+            for_words(stream, members.size(), [&](std::size_t j, std::uint32_t w)
+            {
+                keys[offset + j] = {(j + w * 0x1p-32) / n, first[j]};
+            });
+            offset += members.size();
+        }
+        std::sort(keys.begin(), keys.end());
+        for (std::size_t i = 0; i < keys.size(); i++)
+            order[i] = keys[i].second;
+        break;
+    }
+
+    case Sampling::weighted:
+    {
+        /*two words per draw, one picks the column of the table and one accepts it or its alias*/
+        std::uint64_t n = probability.size();
+        std::uint32_t column = 0;
+        for_words(stream, 2 * order.size(), [&](std::size_t k, std::uint32_t w)
+        {
+            if (k % 2 == 0)
+            {
+                column = static_cast<std::uint32_t>((w * n) >> 32);
+                return;
+            }
+            order[k / 2] = (w * 0x1p-32 < probability[column]) ? static_cast<int>(column) : alias[column];
+        });
+        break;
+    }
+    }
+
+    return order;
+}
@@ -0,0 +1,1638 @@
+#include "simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PHOENIX_SIMD_X86 1
+#else
+#define PHOENIX_SIMD_X86 0
+#endif
+
+namespace phoenix {
+namespace simd {
+
+namespace {
+
+/*Scalar kernels, also used to finish the tail of every vector kernel*/
+
+template <typename T>
+void gemv_scalar(int rows, int cols, const T *a, std::ptrdiff_t lda, const T *x, T *y)
+{
+    for (int k = 0; k < rows; k++)
+    {
+        const T *row = a + k * lda;
+        T sum = 0;
+        for (int i = 0; i < cols; i++)
+        {
+            sum += row[i] * x[i];
+        }
+        y[k] = sum;
+    }
+}
+
+void gemv_s8_scalar(int rows, int cols, const std::int8_t *a, std::ptrdiff_t lda, const std::int8_t *x, std::int32_t *y)
+{
+    for (int k = 0; k < rows; k++)
+    {
+        const std::int8_t *row = a + k * lda;
+        std::int32_t sum = 0;
+        for (int i = 0; i < cols; i++)
+        {
+            sum += static_cast<std::int32_t>(row[i]) * x[i];
+        }
+        y[k] = sum;
+    }
+}
+
+/*Philox4x32-10 constants (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")*/
+constexpr std::uint32_t philox_m0 = 0xD2511F53u, philox_m1 = 0xCD9E8D57u;
+constexpr std::uint32_t philox_w0 = 0x9E3779B9u, philox_w1 = 0xBB67AE85u;
+constexpr int philox_rounds = 10;
+
+void philox_scalar(std::uint64_t counter, std::uint64_t stream, std::uint64_t key, int blocks, std::uint32_t *out)
+{
+    for (int b = 0; b < blocks; b++)
+    {
+        std::uint64_t n = counter + b;
+        std::uint32_t c0 = static_cast<std::uint32_t>(n), c1 = static_cast<std::uint32_t>(n >> 32);
+        std::uint32_t c2 = static_cast<std::uint32_t>(stream), c3 = static_cast<std::uint32_t>(stream >> 32);
+        std::uint32_t k0 = static_cast<std::uint32_t>(key), k1 = static_cast<std::uint32_t>(key >> 32);
+
+        for (int r = 0; r < philox_rounds; r++)
+        {
+            std::uint64_t p0 = static_cast<std::uint64_t>(philox_m0) * c0;
+            std::uint64_t p1 = static_cast<std::uint64_t>(philox_m1) * c2;
+            std::uint32_t next0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            std::uint32_t next2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c1 = static_cast<std::uint32_t>(p1);
+            c3 = static_cast<std::uint32_t>(p0);
+            c0 = next0;
+            c2 = next2;
+            k0 += philox_w0;
+            k1 += philox_w1;
+        }
+
+        out[4 * b] = c0;
+        out[4 * b + 1] = c1;
+        out[4 * b + 2] = c2;
+        out[4 * b + 3] = c3;
+    }
+}
+
+/*computes columns [first, last) of y = A^T * x, one axpy over each row of A*/
+template <typename T>
+void gemv_t_columns(int rows, int first, int last, const T *a, std::ptrdiff_t lda, const T *x, T *y)
+{
+    for (int i = first; i < last; i++)
+        y[i] = 0;
+
+    for (int k = 0; k < rows; k++)
+    {
+        const T *row = a + k * lda;
+        T xk = x[k];
+        for (int i = first; i < last; i++)
+        {
+            y[i] += xk * row[i];
+        }
+    }
+}
+
+template <typename T>
+void gemv_t_scalar(int rows, int cols, const T *a, std::ptrdiff_t lda, const T *x, T *y)
+{
+    gemv_t_columns(rows, 0, cols, a, lda, x, y);
+}
+
+/*columns of y swept per pass over A, small enough for the block of y to stay in L1*/
+constexpr int gemv_t_block = 1024;
+
+template <typename T>
+void gemm_tile_scalar(int kc, const T *a, const T *b, T *c, std::ptrdiff_t rsc, std::ptrdiff_t csc, int mr, int nr)
+{
+    constexpr int MR = tile_shape<T>::rows;
+    constexpr int NR = tile_shape<T>::cols;
+
+    T acc[MR][NR] = {};
+    for (int p = 0; p < kc; p++)
+    {
+        for (int i = 0; i < MR; i++)
+        {
+            for (int j = 0; j < NR; j++)
+            {
+                acc[i][j] += a[p * MR + i] * b[p * NR + j];
+            }
+        }
+    }
+
+    for (int i = 0; i < mr; i++)
+    {
+        for (int j = 0; j < nr; j++)
+        {
+            c[i * rsc + j * csc] += acc[i][j];
+        }
+    }
+}
+
+/*adds a full register tile spilled to memory into a partial or strided C tile*/
+template <typename T>
+void gemm_tile_store(const T *tile, T *c, std::ptrdiff_t rsc, std::ptrdiff_t csc, int mr, int nr)
+{
+    for (int i = 0; i < mr; i++)
+    {
+        for (int j = 0; j < nr; j++)
+        {
+            c[i * rsc + j * csc] += tile[i * tile_shape<T>::cols + j];
+        }
+    }
+}
+
+template <typename T>
+void momentum_scalar(int n, T *p, const T *g, T *v, T mu, T rate, T a, T c)
+{
+    for (int i = 0; i < n; i++)
+    {
+        T vi = mu * v[i] - rate * g[i];
+        v[i] = vi;
+        p[i] += a * vi + c * g[i];
+    }
+}
+
+template <typename T>
+void adaptive_scalar(int n, T *p, const T *g, T *m, T *v, T b1, T b2, T rate, T eps)
+{
+    for (int i = 0; i < n; i++)
+    {
+        T gi = g[i];
+        T mi = gi;
+        if (m != nullptr)
+        {
+            mi = b1 * m[i] + (1 - b1) * gi;
+            m[i] = mi;
+        }
+        T vi = b2 * v[i] + (1 - b2) * gi * gi;
+        v[i] = vi;
+        p[i] -= rate * mi / (std::sqrt(vi) + eps);
+    }
+}
+
+template <typename T>
+void vadd_scalar(const T *a, const T *b, T *out, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        out[i] = a[i] + b[i];
+    }
+}
+
+/*1/k! for the Taylor polynomial of exp(r) - 1 on the reduced range*/
+constexpr double exp_coefficient[] = {1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040, 1.0 / 40320};
+
+/*polynomial degree per accuracy, the remainder r^(d+1)/(d+1)! at |r| = ln2/2 is 5e-9 and 6e-4*/
+constexpr int degree_high = 7;
+constexpr int degree_fast = 3;
+
+constexpr double half_ln2 = 0.34657359027997265471;
+
+/**
+ * @brief Range reduction constants, exp(x) = 2^k * exp(r) with r = x - k * ln2 and |r| <= ln2 / 2.
+ *        \n ln2 is split so that k * ln2_hi is exact; x is clamped to [lo, hi] so 2^k stays normal.
+ *        \n shifter is 1.5 * 2^mantissa, used to round in the scalar kernels.
+ */
+template <typename T>
+struct exp_constants;
+
+template <>
+struct exp_constants<double>
+{
+    using bits = std::uint64_t;
+    static constexpr int mantissa = 52, bias = 1023;
+    static constexpr double lo = -708.0, hi = 709.0, shifter = 6755399441055744.0;
+    static constexpr double log2e = 1.44269504088896340736;
+    static constexpr double ln2_hi = 6.93145751953125e-1, ln2_lo = 1.42860682030941723212e-6;
+};
+
+template <>
+struct exp_constants<float>
+{
+    using bits = std::uint32_t;
+    static constexpr int mantissa = 23, bias = 127;
+    static constexpr float lo = -87.0f, hi = 88.0f, shifter = 12582912.0f;
+    static constexpr float log2e = 1.44269504088896341f;
+    static constexpr float ln2_hi = 0.693359375f, ln2_lo = -2.12194440e-4f;
+};
+
+template <int D, typename T>
+T expm1_poly(T r)
+{
+    T q = static_cast<T>(exp_coefficient[D]);
+    for (int k = D - 1; k >= 1; k--)
+        q = q * r + static_cast<T>(exp_coefficient[k]);
+    return q * r;
+}
+
+template <int D, typename T>
+T exp_approx(T x)
+{
+    using c = exp_constants<T>;
+    /*NaN passes the clamp and must not reach the integer conversion of k*/
+    if (x != x)
+        return x;
+    x = std::min(std::max(x, c::lo), c::hi);
+    /*adding 1.5 * 2^mantissa rounds to the nearest integer without a libm call*/
+    T k = (x * c::log2e + c::shifter) - c::shifter;
+    T r = (x - k * c::ln2_hi) - k * c::ln2_lo;
+
+    /*2^k built directly in the exponent field, no libm call*/
+    typename c::bits e = static_cast<typename c::bits>(static_cast<int>(k) + c::bias) << c::mantissa;
+    T scale;
+    std::memcpy(&scale, &e, sizeof(scale));
+    return (T(1) + expm1_poly<D>(r)) * scale;
+}
+
+/*tanh(x) = e / (e + 2) with e = exp(2|x|) - 1, taken from the polynomial directly near zero*/
+template <int D, typename T>
+T tanh_approx(T x)
+{
+    T u = std::min(2 * std::fabs(x), exp_constants<T>::hi);
+    T e = u < static_cast<T>(half_ln2) ? expm1_poly<D>(u) : exp_approx<D>(u) - T(1);
+    return std::copysign(e / (e + T(2)), x);
+}
+
+template <int D, typename T>
+void vexp_scalar(int n, const T *x, T *y)
+{
+    for (int i = 0; i < n; i++)
+        y[i] = exp_approx<D>(x[i]);
+}
+
+template <int D, typename T>
+void vsigmoid_scalar(int n, const T *x, T *y)
+{
+    for (int i = 0; i < n; i++)
+        y[i] = T(1) / (T(1) + exp_approx<D>(-x[i]));
+}
+
+template <int D, typename T>
+void vtanh_scalar(int n, const T *x, T *y)
+{
+    for (int i = 0; i < n; i++)
+        y[i] = tanh_approx<D>(x[i]);
+}
+
+/*the table holds one entry per function, the polynomial degree is picked once per call*/
+template <typename T, void (*High)(int, const T *, T *), void (*Fast)(int, const T *, T *)>
+void by_degree(int n, const T *x, T *y, int degree)
+{
+    if (degree == degree_fast)
+        Fast(n, x, y);
+    else
+        High(n, x, y);
+}
+
+#if PHOENIX_SIMD_X86
+
+/*SSE2 kernels*/
+
+__attribute__((target("sse2"))) inline double hsum_sse2(__m128d v)
+{
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+__attribute__((target("sse2"))) inline float hsum_sse2(__m128 v)
+{
+    __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+}
+
+__attribute__((target("sse2"))) void gemv_sse2(int rows, int cols, const double *a, std::ptrdiff_t lda,
+                                               const double *x, double *y)
+{
+    int k = 0;
+    for (; k + 4 <= rows; k += 4)
+    {
+        const double *r0 = a + k * lda, *r1 = r0 + lda, *r2 = r1 + lda, *r3 = r2 + lda;
+        __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(), s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+        int i = 0;
+        for (; i + 2 <= cols; i += 2)
+        {
+            __m128d xv = _mm_loadu_pd(x + i);
+            s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(r0 + i), xv));
+            s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(r1 + i), xv));
+            s2 = _mm_add_pd(s2, _mm_mul_pd(_mm_loadu_pd(r2 + i), xv));
+            s3 = _mm_add_pd(s3, _mm_mul_pd(_mm_loadu_pd(r3 + i), xv));
+        }
+        double t0 = hsum_sse2(s0), t1 = hsum_sse2(s1), t2 = hsum_sse2(s2), t3 = hsum_sse2(s3);
+        for (; i < cols; i++)
+        {
+            t0 += r0[i] * x[i];
+            t1 += r1[i] * x[i];
+            t2 += r2[i] * x[i];
+            t3 += r3[i] * x[i];
+        }
+        y[k] = t0;
+        y[k + 1] = t1;
+        y[k + 2] = t2;
+        y[k + 3] = t3;
+    }
+    for (; k < rows; k++)
+    {
+        const double *r0 = a + k * lda;
+        __m128d s0 = _mm_setzero_pd();
+        int i = 0;
+        for (; i + 2 <= cols; i += 2)
+            s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(r0 + i), _mm_loadu_pd(x + i)));
+        double t0 = hsum_sse2(s0);
+        for (; i < cols; i++)
+            t0 += r0[i] * x[i];
+        y[k] = t0;
+    }
+}
+
+__attribute__((target("sse2"))) void gemv_sse2(int rows, int cols, const float *a, std::ptrdiff_t lda,
+                                               const float *x, float *y)
+{
+    int k = 0;
+    for (; k + 4 <= rows; k += 4)
+    {
+        const float *r0 = a + k * lda, *r1 = r0 + lda, *r2 = r1 + lda, *r3 = r2 + lda;
+        __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps(), s2 = _mm_setzero_ps(), s3 = _mm_setzero_ps();
+        int i = 0;
+        for (; i + 4 <= cols; i += 4)
+        {
+            __m128 xv = _mm_loadu_ps(x + i);
+            s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(r0 + i), xv));
+            s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(r1 + i), xv));
+            s2 = _mm_add_ps(s2, _mm_mul_ps(_mm_loadu_ps(r2 + i), xv));
+            s3 = _mm_add_ps(s3, _mm_mul_ps(_mm_loadu_ps(r3 + i), xv));
+        }
+        float t0 = hsum_sse2(s0), t1 = hsum_sse2(s1), t2 = hsum_sse2(s2), t3 = hsum_sse2(s3);
+        for (; i < cols; i++)
+        {
+            t0 += r0[i] * x[i];
+            t1 += r1[i] * x[i];
+            t2 += r2[i] * x[i];
+            t3 += r3[i] * x[i];
+        }
+        y[k] = t0;
+        y[k + 1] = t1;
+        y[k + 2] = t2;
+        y[k + 3] = t3;
+    }
+    for (; k < rows; k++)
+    {
+        const float *r0 = a + k * lda;
+        __m128 s0 = _mm_setzero_ps();
+        int i = 0;
+        for (; i + 4 <= cols; i += 4)
+            s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(r0 + i), _mm_loadu_ps(x + i)));
+        float t0 = hsum_sse2(s0);
+        for (; i < cols; i++)
+            t0 += r0[i] * x[i];
+        y[k] = t0;
+    }
+}
+
+__attribute__((target("sse2"))) void gemv_t_sse2(int rows, int cols, const double *a, std::ptrdiff_t lda,
+                                                 const double *x, double *y)
+{
+    int vec_cols = cols - cols % 2;
+    for (int j0 = 0; j0 < vec_cols; j0 += gemv_t_block)
+    {
+        int j1 = std::min(j0 + gemv_t_block, vec_cols);
+        for (int i = j0; i < j1; i += 2)
+            _mm_storeu_pd(y + i, _mm_setzero_pd());
+
+        int k = 0;
+        for (; k + 4 <= rows; k += 4)
+        {
+            const double *r0 = a + k * lda, *r1 = r0 + lda, *r2 = r1 + lda, *r3 = r2 + lda;
+            __m128d x0 = _mm_set1_pd(x[k]), x1 = _mm_set1_pd(x[k + 1]);
+            __m128d x2 = _mm_set1_pd(x[k + 2]), x3 = _mm_set1_pd(x[k + 3]);
+            for (int i = j0; i < j1; i += 2)
+            {
+                __m128d acc = _mm_loadu_pd(y + i);
+                acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(r0 + i), x0));
+                acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(r1 + i), x1));
+                acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(r2 + i), x2));
+                acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(r3 + i), x3));
+                _mm_storeu_pd(y + i, acc);
+            }
+        }
+        for (; k < rows; k++)
+        {
+            const double *r0 = a + k * lda;
+            __m128d x0 = _mm_set1_pd(x[k]);
+            for (int i = j0; i < j1; i += 2)
+                _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(_mm_loadu_pd(r0 + i), x0)));
+        }
+    }
+    gemv_t_columns(rows, vec_cols, cols, a, lda, x, y);
+}
+
+__attribute__((target("sse2"))) void gemv_t_sse2(int rows, int cols, const float *a, std::ptrdiff_t lda,
+                                                 const float *x, float *y)
+{
+    int vec_cols = cols - cols % 4;
+    for (int j0 = 0; j0 < vec_cols; j0 += gemv_t_block)
+    {
+        int j1 = std::min(j0 + gemv_t_block, vec_cols);
+        for (int i = j0; i < j1; i += 4)
+            _mm_storeu_ps(y + i, _mm_setzero_ps());
+
+        int k = 0;
+        for (; k + 4 <= rows; k += 4)
+        {
+            const float *r0 = a + k * lda, *r1 = r0 + lda, *r2 = r1 + lda, *r3 = r2 + lda;
+            __m128 x0 = _mm_set1_ps(x[k]), x1 = _mm_set1_ps(x[k + 1]);
+            __m128 x2 = _mm_set1_ps(x[k + 2]), x3 = _mm_set1_ps(x[k + 3]);
+            for (int i = j0; i < j1; i += 4)
+            {
+                __m128 acc = _mm_loadu_ps(y + i);
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(r0 + i), x0));
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(r1 + i), x1));
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(r2 + i), x2));
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(r3 + i), x3));
+                _mm_storeu_ps(y + i, acc);
+            }
+        }
+        for (; k < rows; k++)
+        {
+            const float *r0 = a + k * lda;
+            __m128 x0 = _mm_set1_ps(x[k]);
+            for (int i = j0; i < j1; i += 4)
+                _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(_mm_loadu_ps(r0 + i), x0)));
+        }
+    }
+    gemv_t_columns(rows, vec_cols, cols, a, lda, x, y);
+}
+
+__attribute__((target("sse2"))) void vadd_sse2(const double *a, const double *b, double *out, int n)
+{
+    int i = 0;
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    vadd_scalar(a + i, b + i, out + i, n - i);
+}
+
+__attribute__((target("sse2"))) void vadd_sse2(const float *a, const float *b, float *out, int n)
+{
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    vadd_scalar(a + i, b + i, out + i, n - i);
+}
+
+/*AVX2 + FMA kernels*/
+
+__attribute__((target("avx2,fma"))) inline double hsum_avx2(__m256d v)
+{
+    __m128d lo = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+__attribute__((target("avx2,fma"))) inline float hsum_avx2(__m256 v)
+{
+    __m128 lo = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    __m128 shuf = _mm_movehdup_ps(lo);
+    __m128 sums = _mm_add_ps(lo, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+}
+
+__attribute__((target("avx2,fma"))) void gemv_avx2(int rows, int cols, const double *a, std::ptrdiff_t lda,
+                                                   const double *x, double *y)
+{
+    int k = 0;
+    for (; k + 4 <= rows; k += 4)
+    {
+        const double *r0 = a + k * lda, *r1 = r0 + lda, *r2 = r1 + lda, *r3 = r2 + lda;
+        __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+        int i = 0;
+        for (; i + 4 <= cols; i += 4)
+        {
+            __m256d xv = _mm256_loadu_pd(x + i);
+            s0 = _mm256_fmadd_pd(_mm256_loadu_pd(r0 + i), xv, s0);
+            s1 = _mm256_fmadd_pd(_mm256_loadu_pd(r1 + i), xv, s1);
+            s2 = _mm256_fmadd_pd(_mm256_loadu_pd(r2 + i), xv, s2);
+            s3 = _mm256_fmadd_pd(_mm256_loadu_pd(r3 + i), xv, s3);
+        }
+        double t0 = hsum_avx2(s0), t1 = hsum_avx2(s1), t2 = hsum_avx2(s2), t3 = hsum_avx2(s3);
+        for (; i < cols; i++)
+        {
+            t0 += r0[i] * x[i];
+            t1 += r1[i] * x[i];
+            t2 += r2[i] * x[i];
+            t3 += r3[i] * x[i];
+        }
+        y[k] = t0;
+        y[k + 1] = t1;
+        y[k + 2] = t2;
+        y[k + 3] = t3;
+    }
+    for (; k < rows; k++)
+    {
+        const double *r0 = a + k * lda;
+        __m256d s0 = _mm256_setzero_pd();
+        int i = 0;
+        for (; i + 4 <= cols; i += 4)
+            s0 = _mm256_fmadd_pd(_mm256_loadu_pd(r0 + i), _mm256_loadu_pd(x + i), s0);
+        double t0 = hsum_avx2(s0);
+        for (; i < cols; i++)
+            t0 += r0[i] * x[i];
+        y[k] = t0;
+    }
+}
+
+__attribute__((target("avx2,fma"))) void gemv_avx2(int rows, int cols, const float *a, std::ptrdiff_t lda,
+                                                   const float *x, float *y)
+{
+    int k = 0;
+    for (; k + 4 <= rows; k += 4)
+    {
+        const float *r0 = a + k * lda, *r1 = r0 + lda, *r2 = r1 + lda, *r3 = r2 + lda;
+        __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps(), s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+        int i = 0;
+        for (; i + 8 <= cols; i += 8)
+        {
+            __m256 xv = _mm256_loadu_ps(x + i);
+            s0 = _mm256_fmadd_ps(_mm256_loadu_ps(r0 + i), xv, s0);
+            s1 = _mm256_fmadd_ps(_mm256_loadu_ps(r1 + i), xv, s1);
+            s2 = _mm256_fmadd_ps(_mm256_loadu_ps(r2 + i), xv, s2);
+            s3 = _mm256_fmadd_ps(_mm256_loadu_ps(r3 + i), xv, s3);
+        }
+        float t0 = hsum_avx2(s0), t1 = hsum_avx2(s1), t2 = hsum_avx2(s2), t3 = hsum_avx2(s3);
+        for (; i < cols; i++)
+        {
+            t0 += r0[i] * x[i];
+            t1 += r1[i] * x[i];
+            t2 += r2[i] * x[i];
+            t3 += r3[i] * x[i];
+        }
+        y[k] = t0;
+        y[k + 1] = t1;
+        y[k + 2] = t2;
+        y[k + 3] = t3;
+    }
+    for (; k < rows; k++)
+    {
+        const float *r0 = a + k * lda;
+        __m256 s0 = _mm256_setzero_ps();
+        int i = 0;
+        for (; i + 8 <= cols; i += 8)
+            s0 = _mm256_fmadd_ps(_mm256_loadu_ps(r0 + i), _mm256_loadu_ps(x + i), s0);
+        float t0 = hsum_avx2(s0);
+        for (; i < cols; i++)
+            t0 += r0[i] * x[i];
+        y[k] = t0;
+    }
+}
+
+__attribute__((target("avx2,fma"))) void gemv_t_avx2(int rows, int cols, const double *a, std::ptrdiff_t lda,
+                                                     const double *x, double *y)
+{
+    int vec_cols = cols - cols % 4;
+    for (int j0 = 0; j0 < vec_cols; j0 += gemv_t_block)
+    {
+        int j1 = std::min(j0 + gemv_t_block, vec_cols);
+        for (int i = j0; i < j1; i += 4)
+            _mm256_storeu_pd(y + i, _mm256_setzero_pd());
+
+        int k = 0;
+        for (; k + 4 <= rows; k += 4)
+        {
+            const double *r0 = a + k * lda, *r1 = r0 + lda, *r2 = r1 + lda, *r3 = r2 + lda;
+            __m256d x0 = _mm256_set1_pd(x[k]), x1 = _mm256_set1_pd(x[k + 1]);
+            __m256d x2 = _mm256_set1_pd(x[k + 2]), x3 = _mm256_set1_pd(x[k + 3]);
+            for (int i = j0; i < j1; i += 4)
+            {
+                __m256d acc = _mm256_loadu_pd(y + i);
+                acc = _mm256_fmadd_pd(_mm256_loadu_pd(r0 + i), x0, acc);
+                acc = _mm256_fmadd_pd(_mm256_loadu_pd(r1 + i), x1, acc);
+                acc = _mm256_fmadd_pd(_mm256_loadu_pd(r2 + i), x2, acc);
+                acc = _mm256_fmadd_pd(_mm256_loadu_pd(r3 + i), x3, acc);
+                _mm256_storeu_pd(y + i, acc);
+            }
+        }
+        for (; k < rows; k++)
+        {
+            const double *r0 = a + k * lda;
+            __m256d x0 = _mm256_set1_pd(x[k]);
+            for (int i = j0; i < j1; i += 4)
+                _mm256_storeu_pd(y + i, _mm256_fmadd_pd(_mm256_loadu_pd(r0 + i), x0, _mm256_loadu_pd(y + i)));
+        }
+    }
+    gemv_t_columns(rows, vec_cols, cols, a, lda, x, y);
+}
+
+__attribute__((target("avx2,fma"))) void gemv_t_avx2(int rows, int cols, const float *a, std::ptrdiff_t lda,
+                                                     const float *x, float *y)
+{
+    int vec_cols = cols - cols % 8;
+    for (int j0 = 0; j0 < vec_cols; j0 += gemv_t_block)
+    {
+        int j1 = std::min(j0 + gemv_t_block, vec_cols);
+        for (int i = j0; i < j1; i += 8)
+            _mm256_storeu_ps(y + i, _mm256_setzero_ps());
+
+        int k = 0;
+        for (; k + 4 <= rows; k += 4)
+        {
+            const float *r0 = a + k * lda, *r1 = r0 + lda, *r2 = r1 + lda, *r3 = r2 + lda;
+            __m256 x0 = _mm256_set1_ps(x[k]), x1 = _mm256_set1_ps(x[k + 1]);
+            __m256 x2 = _mm256_set1_ps(x[k + 2]), x3 = _mm256_set1_ps(x[k + 3]);
+            for (int i = j0; i < j1; i += 8)
+            {
+                __m256 acc = _mm256_loadu_ps(y + i);
+                acc = _mm256_fmadd_ps(_mm256_loadu_ps(r0 + i), x0, acc);
+                acc = _mm256_fmadd_ps(_mm256_loadu_ps(r1 + i), x1, acc);
+                acc = _mm256_fmadd_ps(_mm256_loadu_ps(r2 + i), x2, acc);
+                acc = _mm256_fmadd_ps(_mm256_loadu_ps(r3 + i), x3, acc);
+                _mm256_storeu_ps(y + i, acc);
+            }
+        }
+        for (; k < rows; k++)
+        {
+            const float *r0 = a + k * lda;
+            __m256 x0 = _mm256_set1_ps(x[k]);
+            for (int i = j0; i < j1; i += 8)
+                _mm256_storeu_ps(y + i, _mm256_fmadd_ps(_mm256_loadu_ps(r0 + i), x0, _mm256_loadu_ps(y + i)));
+        }
+    }
+    gemv_t_columns(rows, vec_cols, cols, a, lda, x, y);
+}
+
+__attribute__((target("avx2,fma"))) void gemm_tile_avx2(int kc, const double *a, const double *b, double *c,
+                                                        std::ptrdiff_t rsc, std::ptrdiff_t csc, int mr, int nr)
+{
+    /*4 x 8 tile: two ymm per row, eight independent FMA chains*/
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+
+    for (int p = 0; p < kc; p++)
+    {
+        __m256d b0 = _mm256_loadu_pd(b + 8 * p);
+        __m256d b1 = _mm256_loadu_pd(b + 8 * p + 4);
+        const double *ap = a + 4 * p;
+
+        __m256d a0 = _mm256_broadcast_sd(ap);
+        c00 = _mm256_fmadd_pd(a0, b0, c00);
+        c01 = _mm256_fmadd_pd(a0, b1, c01);
+        __m256d a1 = _mm256_broadcast_sd(ap + 1);
+        c10 = _mm256_fmadd_pd(a1, b0, c10);
+        c11 = _mm256_fmadd_pd(a1, b1, c11);
+        __m256d a2 = _mm256_broadcast_sd(ap + 2);
+        c20 = _mm256_fmadd_pd(a2, b0, c20);
+        c21 = _mm256_fmadd_pd(a2, b1, c21);
+        __m256d a3 = _mm256_broadcast_sd(ap + 3);
+        c30 = _mm256_fmadd_pd(a3, b0, c30);
+        c31 = _mm256_fmadd_pd(a3, b1, c31);
+    }
+
+    if (mr == 4 && nr == 8 && csc == 1)
+    {
+        __m256d rows[4][2] = {{c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}};
+        for (int i = 0; i < 4; i++)
+        {
+            double *ci = c + i * rsc;
+            _mm256_storeu_pd(ci, _mm256_add_pd(_mm256_loadu_pd(ci), rows[i][0]));
+            _mm256_storeu_pd(ci + 4, _mm256_add_pd(_mm256_loadu_pd(ci + 4), rows[i][1]));
+        }
+        return;
+    }
+
+    alignas(32) double tile[4 * 8];
+    _mm256_store_pd(tile, c00);
+    _mm256_store_pd(tile + 4, c01);
+    _mm256_store_pd(tile + 8, c10);
+    _mm256_store_pd(tile + 12, c11);
+    _mm256_store_pd(tile + 16, c20);
+    _mm256_store_pd(tile + 20, c21);
+    _mm256_store_pd(tile + 24, c30);
+    _mm256_store_pd(tile + 28, c31);
+    gemm_tile_store(tile, c, rsc, csc, mr, nr);
+}
+
+__attribute__((target("avx2,fma"))) void gemm_tile_avx2(int kc, const float *a, const float *b, float *c,
+                                                        std::ptrdiff_t rsc, std::ptrdiff_t csc, int mr, int nr)
+{
+    /*8 x 8 tile: one ymm per row, eight independent FMA chains*/
+    __m256 c0 = _mm256_setzero_ps(), c1 = _mm256_setzero_ps(), c2 = _mm256_setzero_ps(), c3 = _mm256_setzero_ps();
+    __m256 c4 = _mm256_setzero_ps(), c5 = _mm256_setzero_ps(), c6 = _mm256_setzero_ps(), c7 = _mm256_setzero_ps();
+
+    for (int p = 0; p < kc; p++)
+    {
+        __m256 bp = _mm256_loadu_ps(b + 8 * p);
+        const float *ap = a + 8 * p;
+
+        c0 = _mm256_fmadd_ps(_mm256_broadcast_ss(ap), bp, c0);
+        c1 = _mm256_fmadd_ps(_mm256_broadcast_ss(ap + 1), bp, c1);
+        c2 = _mm256_fmadd_ps(_mm256_broadcast_ss(ap + 2), bp, c2);
+        c3 = _mm256_fmadd_ps(_mm256_broadcast_ss(ap + 3), bp, c3);
+        c4 = _mm256_fmadd_ps(_mm256_broadcast_ss(ap + 4), bp, c4);
+        c5 = _mm256_fmadd_ps(_mm256_broadcast_ss(ap + 5), bp, c5);
+        c6 = _mm256_fmadd_ps(_mm256_broadcast_ss(ap + 6), bp, c6);
+        c7 = _mm256_fmadd_ps(_mm256_broadcast_ss(ap + 7), bp, c7);
+    }
+
+    __m256 rows[8] = {c0, c1, c2, c3, c4, c5, c6, c7};
+    if (mr == 8 && nr == 8 && csc == 1)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            float *ci = c + i * rsc;
+            _mm256_storeu_ps(ci, _mm256_add_ps(_mm256_loadu_ps(ci), rows[i]));
+        }
+        return;
+    }
+
+    alignas(32) float tile[8 * 8];
+    for (int i = 0; i < 8; i++)
+    {
+        _mm256_store_ps(tile + 8 * i, rows[i]);
+    }
+    gemm_tile_store(tile, c, rsc, csc, mr, nr);
+}
+
+__attribute__((target("avx2,fma"))) void momentum_avx2(int n, double *p, const double *g, double *v,
+                                                       double mu, double rate, double a, double c)
+{
+    __m256d vmu = _mm256_set1_pd(mu), vrate = _mm256_set1_pd(rate);
+    __m256d va = _mm256_set1_pd(a), vc = _mm256_set1_pd(c);
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d gi = _mm256_loadu_pd(g + i);
+        __m256d vi = _mm256_fnmadd_pd(vrate, gi, _mm256_mul_pd(vmu, _mm256_loadu_pd(v + i)));
+        _mm256_storeu_pd(v + i, vi);
+        __m256d pi = _mm256_fmadd_pd(va, vi, _mm256_loadu_pd(p + i));
+        _mm256_storeu_pd(p + i, _mm256_fmadd_pd(vc, gi, pi));
+    }
+    momentum_scalar(n - i, p + i, g + i, v + i, mu, rate, a, c);
+}
+
+__attribute__((target("avx2,fma"))) void momentum_avx2(int n, float *p, const float *g, float *v,
+                                                       float mu, float rate, float a, float c)
+{
+    __m256 vmu = _mm256_set1_ps(mu), vrate = _mm256_set1_ps(rate);
+    __m256 va = _mm256_set1_ps(a), vc = _mm256_set1_ps(c);
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 gi = _mm256_loadu_ps(g + i);
+        __m256 vi = _mm256_fnmadd_ps(vrate, gi, _mm256_mul_ps(vmu, _mm256_loadu_ps(v + i)));
+        _mm256_storeu_ps(v + i, vi);
+        __m256 pi = _mm256_fmadd_ps(va, vi, _mm256_loadu_ps(p + i));
+        _mm256_storeu_ps(p + i, _mm256_fmadd_ps(vc, gi, pi));
+    }
+    momentum_scalar(n - i, p + i, g + i, v + i, mu, rate, a, c);
+}
+
+__attribute__((target("avx2,fma"))) void adaptive_avx2(int n, double *p, const double *g, double *m, double *v,
+                                                       double b1, double b2, double rate, double eps)
+{
+    __m256d vb1 = _mm256_set1_pd(b1), vc1 = _mm256_set1_pd(1 - b1);
+    __m256d vb2 = _mm256_set1_pd(b2), vc2 = _mm256_set1_pd(1 - b2);
+    __m256d vrate = _mm256_set1_pd(rate), veps = _mm256_set1_pd(eps);
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d gi = _mm256_loadu_pd(g + i);
+        __m256d mi = gi;
+        if (m != nullptr)
+        {
+            mi = _mm256_fmadd_pd(vb1, _mm256_loadu_pd(m + i), _mm256_mul_pd(vc1, gi));
+            _mm256_storeu_pd(m + i, mi);
+        }
+        __m256d vi = _mm256_fmadd_pd(vb2, _mm256_loadu_pd(v + i), _mm256_mul_pd(vc2, _mm256_mul_pd(gi, gi)));
+        _mm256_storeu_pd(v + i, vi);
+
+        __m256d step = _mm256_div_pd(mi, _mm256_add_pd(_mm256_sqrt_pd(vi), veps));
+        _mm256_storeu_pd(p + i, _mm256_fnmadd_pd(vrate, step, _mm256_loadu_pd(p + i)));
+    }
+    adaptive_scalar(n - i, p + i, g + i, m == nullptr ? m : m + i, v + i, b1, b2, rate, eps);
+}
+
+__attribute__((target("avx2,fma"))) void adaptive_avx2(int n, float *p, const float *g, float *m, float *v,
+                                                       float b1, float b2, float rate, float eps)
+{
+    __m256 vb1 = _mm256_set1_ps(b1), vc1 = _mm256_set1_ps(1 - b1);
+    __m256 vb2 = _mm256_set1_ps(b2), vc2 = _mm256_set1_ps(1 - b2);
+    __m256 vrate = _mm256_set1_ps(rate), veps = _mm256_set1_ps(eps);
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 gi = _mm256_loadu_ps(g + i);
+        __m256 mi = gi;
+        if (m != nullptr)
+        {
+            mi = _mm256_fmadd_ps(vb1, _mm256_loadu_ps(m + i), _mm256_mul_ps(vc1, gi));
+            _mm256_storeu_ps(m + i, mi);
+        }
+        __m256 vi = _mm256_fmadd_ps(vb2, _mm256_loadu_ps(v + i), _mm256_mul_ps(vc2, _mm256_mul_ps(gi, gi)));
+        _mm256_storeu_ps(v + i, vi);
+
+        __m256 step = _mm256_div_ps(mi, _mm256_add_ps(_mm256_sqrt_ps(vi), veps));
+        _mm256_storeu_ps(p + i, _mm256_fnmadd_ps(vrate, step, _mm256_loadu_ps(p + i)));
+    }
+    adaptive_scalar(n - i, p + i, g + i, m == nullptr ? m : m + i, v + i, b1, b2, rate, eps);
+}
+
+template <int D>
+__attribute__((target("avx2,fma"))) inline __m256d expm1_poly_avx2(__m256d r)
+{
+    __m256d q = _mm256_set1_pd(exp_coefficient[D]);
+    for (int k = D - 1; k >= 1; k--)
+        q = _mm256_fmadd_pd(q, r, _mm256_set1_pd(exp_coefficient[k]));
+    return _mm256_mul_pd(q, r);
+}
+
+template <int D>
+__attribute__((target("avx2,fma"))) inline __m256 expm1_poly_avx2(__m256 r)
+{
+    __m256 q = _mm256_set1_ps(static_cast<float>(exp_coefficient[D]));
+    for (int k = D - 1; k >= 1; k--)
+        q = _mm256_fmadd_ps(q, r, _mm256_set1_ps(static_cast<float>(exp_coefficient[k])));
+    return _mm256_mul_ps(q, r);
+}
+
+template <int D>
+__attribute__((target("avx2,fma"))) inline __m256d exp_avx2(__m256d x)
+{
+    using c = exp_constants<double>;
+    /*the clamp would turn NaN into a finite value, NaN lanes are blended back at the end*/
+    __m256d nan = _mm256_cmp_pd(x, x, _CMP_UNORD_Q);
+    __m256d input = x;
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(c::lo)), _mm256_set1_pd(c::hi));
+    __m256d k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(c::log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_fnmadd_pd(k, _mm256_set1_pd(c::ln2_hi), x);
+    r = _mm256_fnmadd_pd(k, _mm256_set1_pd(c::ln2_lo), r);
+
+    /*2^k built directly in the exponent field*/
+    __m256i e = _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(k)), _mm256_set1_epi64x(1023));
+    __m256d scale = _mm256_castsi256_pd(_mm256_slli_epi64(e, 52));
+    return _mm256_blendv_pd(_mm256_mul_pd(_mm256_add_pd(expm1_poly_avx2<D>(r), _mm256_set1_pd(1.0)), scale), input, nan);
+}
+
+template <int D>
+__attribute__((target("avx2,fma"))) inline __m256 exp_avx2(__m256 x)
+{
+    using c = exp_constants<float>;
+    __m256 nan = _mm256_cmp_ps(x, x, _CMP_UNORD_Q);
+    __m256 input = x;
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(c::lo)), _mm256_set1_ps(c::hi));
+    __m256 k = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(c::log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(k, _mm256_set1_ps(c::ln2_hi), x);
+    r = _mm256_fnmadd_ps(k, _mm256_set1_ps(c::ln2_lo), r);
+
+    __m256i e = _mm256_add_epi32(_mm256_cvtps_epi32(k), _mm256_set1_epi32(127));
+    __m256 scale = _mm256_castsi256_ps(_mm256_slli_epi32(e, 23));
+    return _mm256_blendv_ps(_mm256_mul_ps(_mm256_add_ps(expm1_poly_avx2<D>(r), _mm256_set1_ps(1.0f)), scale), input, nan);
+}
+
+template <int D>
+__attribute__((target("avx2,fma"))) void vexp_avx2(int n, const double *x, double *y)
+{
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(y + i, exp_avx2<D>(_mm256_loadu_pd(x + i)));
+    vexp_scalar<D>(n - i, x + i, y + i);
+}
+
+template <int D>
+__attribute__((target("avx2,fma"))) void vexp_avx2(int n, const float *x, float *y)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(y + i, exp_avx2<D>(_mm256_loadu_ps(x + i)));
+    vexp_scalar<D>(n - i, x + i, y + i);
+}
+
+template <int D>
+__attribute__((target("avx2,fma"))) void vsigmoid_avx2(int n, const double *x, double *y)
+{
+    __m256d one = _mm256_set1_pd(1.0), zero = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d e = exp_avx2<D>(_mm256_sub_pd(zero, _mm256_loadu_pd(x + i)));
+        _mm256_storeu_pd(y + i, _mm256_div_pd(one, _mm256_add_pd(one, e)));
+    }
+    vsigmoid_scalar<D>(n - i, x + i, y + i);
+}
+
+template <int D>
+__attribute__((target("avx2,fma"))) void vsigmoid_avx2(int n, const float *x, float *y)
+{
+    __m256 one = _mm256_set1_ps(1.0f), zero = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 e = exp_avx2<D>(_mm256_sub_ps(zero, _mm256_loadu_ps(x + i)));
+        _mm256_storeu_ps(y + i, _mm256_div_ps(one, _mm256_add_ps(one, e)));
+    }
+    vsigmoid_scalar<D>(n - i, x + i, y + i);
+}
+
+template <int D>
+__attribute__((target("avx2,fma"))) void vtanh_avx2(int n, const double *x, double *y)
+{
+    __m256d sign = _mm256_set1_pd(-0.0), one = _mm256_set1_pd(1.0), two = _mm256_set1_pd(2.0);
+    __m256d hi = _mm256_set1_pd(exp_constants<double>::hi), small = _mm256_set1_pd(half_ln2);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d xi = _mm256_loadu_pd(x + i);
+        __m256d u = _mm256_min_pd(_mm256_mul_pd(two, _mm256_andnot_pd(sign, xi)), hi);
+        __m256d e = _mm256_blendv_pd(_mm256_sub_pd(exp_avx2<D>(u), one), expm1_poly_avx2<D>(u),
+                                     _mm256_cmp_pd(u, small, _CMP_LT_OQ));
+        __m256d t = _mm256_div_pd(e, _mm256_add_pd(e, two));
+        /*u is clamped, so NaN inputs are passed through explicitly*/
+        t = _mm256_or_pd(t, _mm256_and_pd(sign, xi));
+        _mm256_storeu_pd(y + i, _mm256_blendv_pd(t, xi, _mm256_cmp_pd(xi, xi, _CMP_UNORD_Q)));
+    }
+    vtanh_scalar<D>(n - i, x + i, y + i);
+}
+
+template <int D>
+__attribute__((target("avx2,fma"))) void vtanh_avx2(int n, const float *x, float *y)
+{
+    __m256 sign = _mm256_set1_ps(-0.0f), one = _mm256_set1_ps(1.0f), two = _mm256_set1_ps(2.0f);
+    __m256 hi = _mm256_set1_ps(exp_constants<float>::hi), small = _mm256_set1_ps(static_cast<float>(half_ln2));
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 xi = _mm256_loadu_ps(x + i);
+        __m256 u = _mm256_min_ps(_mm256_mul_ps(two, _mm256_andnot_ps(sign, xi)), hi);
+        __m256 e = _mm256_blendv_ps(_mm256_sub_ps(exp_avx2<D>(u), one), expm1_poly_avx2<D>(u),
+                                    _mm256_cmp_ps(u, small, _CMP_LT_OQ));
+        __m256 t = _mm256_div_ps(e, _mm256_add_ps(e, two));
+        t = _mm256_or_ps(t, _mm256_and_ps(sign, xi));
+        _mm256_storeu_ps(y + i, _mm256_blendv_ps(t, xi, _mm256_cmp_ps(xi, xi, _CMP_UNORD_Q)));
+    }
+    vtanh_scalar<D>(n - i, x + i, y + i);
+}
+
+__attribute__((target("avx2,fma"))) void vadd_avx2(const double *a, const double *b, double *out, int n)
+{
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    vadd_scalar(a + i, b + i, out + i, n - i);
+}
+
+__attribute__((target("avx2,fma"))) void vadd_avx2(const float *a, const float *b, float *out, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    vadd_scalar(a + i, b + i, out + i, n - i);
+}
+
+__attribute__((target("avx2,fma"))) inline std::int32_t hsum_avx2(__m256i v)
+{
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+__attribute__((target("avx2,fma"))) inline __m256i load_s8_avx2(const std::int8_t *p)
+{
+    return _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+}
+
+/*int8 pairs are widened to int16 and multiplied-added into int32 lanes (vpmaddwd)*/
+__attribute__((target("avx2,fma"))) void gemv_s8_avx2(int rows, int cols, const std::int8_t *a, std::ptrdiff_t lda,
+                                                      const std::int8_t *x, std::int32_t *y)
+{
+    int k = 0;
+    for (; k + 4 <= rows; k += 4)
+    {
+        const std::int8_t *r0 = a + k * lda, *r1 = r0 + lda, *r2 = r1 + lda, *r3 = r2 + lda;
+        __m256i s0 = _mm256_setzero_si256(), s1 = _mm256_setzero_si256();
+        __m256i s2 = _mm256_setzero_si256(), s3 = _mm256_setzero_si256();
+        int i = 0;
+        for (; i + 16 <= cols; i += 16)
+        {
+            __m256i xv = load_s8_avx2(x + i);
+            s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(load_s8_avx2(r0 + i), xv));
+            s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(load_s8_avx2(r1 + i), xv));
+            s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(load_s8_avx2(r2 + i), xv));
+            s3 = _mm256_add_epi32(s3, _mm256_madd_epi16(load_s8_avx2(r3 + i), xv));
+        }
+        std::int32_t t0 = hsum_avx2(s0), t1 = hsum_avx2(s1), t2 = hsum_avx2(s2), t3 = hsum_avx2(s3);
+        for (; i < cols; i++)
+        {
+            t0 += static_cast<std::int32_t>(r0[i]) * x[i];
+            t1 += static_cast<std::int32_t>(r1[i]) * x[i];
+            t2 += static_cast<std::int32_t>(r2[i]) * x[i];
+            t3 += static_cast<std::int32_t>(r3[i]) * x[i];
+        }
+        y[k] = t0;
+        y[k + 1] = t1;
+        y[k + 2] = t2;
+        y[k + 3] = t3;
+    }
+    for (; k < rows; k++)
+    {
+        const std::int8_t *r0 = a + k * lda;
+        __m256i s0 = _mm256_setzero_si256();
+        int i = 0;
+        for (; i + 16 <= cols; i += 16)
+            s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(load_s8_avx2(r0 + i), load_s8_avx2(x + i)));
+        std::int32_t t0 = hsum_avx2(s0);
+        for (; i < cols; i++)
+            t0 += static_cast<std::int32_t>(r0[i]) * x[i];
+        y[k] = t0;
+    }
+}
+
+/*hi and lo words of the 32 x 32 bit products of the eight lanes of a with m*/
+__attribute__((target("avx2,fma"))) inline void mulhilo_avx2(__m256i a, __m256i m, __m256i &hi, __m256i &lo)
+{
+    __m256i even = _mm256_mul_epu32(a, m);
+    __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+    lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+/*eight counters per iteration, one per lane*/
+__attribute__((target("avx2,fma"))) void philox_avx2(std::uint64_t counter, std::uint64_t stream, std::uint64_t key,
+                                                     int blocks, std::uint32_t *out)
+{
+    const __m256i m0 = _mm256_set1_epi32(static_cast<int>(philox_m0));
+    const __m256i m1 = _mm256_set1_epi32(static_cast<int>(philox_m1));
+    alignas(32) std::uint32_t lo[8], hi[8], c[4][8];
+
+    int b = 0;
+    for (; b + 8 <= blocks; b += 8)
+    {
+        for (int l = 0; l < 8; l++)
+        {
+            std::uint64_t n = counter + b + l;
+            lo[l] = static_cast<std::uint32_t>(n);
+            hi[l] = static_cast<std::uint32_t>(n >> 32);
+        }
+
+        __m256i c0 = _mm256_load_si256(reinterpret_cast<const __m256i *>(lo));
+        __m256i c1 = _mm256_load_si256(reinterpret_cast<const __m256i *>(hi));
+        __m256i c2 = _mm256_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(stream)));
+        __m256i c3 = _mm256_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(stream >> 32)));
+        std::uint32_t k0 = static_cast<std::uint32_t>(key), k1 = static_cast<std::uint32_t>(key >> 32);
+
+        for (int r = 0; r < philox_rounds; r++)
+        {
+            __m256i hi0, lo0, hi1, lo1;
+            mulhilo_avx2(c0, m0, hi0, lo0);
+            mulhilo_avx2(c2, m1, hi1, lo1);
+            c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32(static_cast<int>(k0)));
+            c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32(static_cast<int>(k1)));
+            c1 = lo1;
+            c3 = lo0;
+            k0 += philox_w0;
+            k1 += philox_w1;
+        }
+
+        _mm256_store_si256(reinterpret_cast<__m256i *>(c[0]), c0);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(c[1]), c1);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(c[2]), c2);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(c[3]), c3);
+        for (int l = 0; l < 8; l++)
+        {
+            std::uint32_t *block = out + 4 * static_cast<std::size_t>(b + l);
+            block[0] = c[0][l];
+            block[1] = c[1][l];
+            block[2] = c[2][l];
+            block[3] = c[3][l];
+        }
+    }
+
+    philox_scalar(counter + b, stream, key, blocks - b, out + 4 * static_cast<std::size_t>(b));
+}
+
+/*AVX-512 kernels*/
+
+__attribute__((target("avx512f,avx2,fma"))) inline double hsum_avx512(__m512d v)
+{
+    __m512d hi = _mm512_shuffle_f64x2(v, v, _MM_SHUFFLE(3, 2, 3, 2));
+    return hsum_avx2(_mm256_add_pd(_mm512_castpd512_pd256(v), _mm512_castpd512_pd256(hi)));
+}
+
+__attribute__((target("avx512f,avx2,fma"))) inline float hsum_avx512(__m512 v)
+{
+    __m512 hi = _mm512_shuffle_f32x4(v, v, _MM_SHUFFLE(3, 2, 3, 2));
+    return hsum_avx2(_mm256_add_ps(_mm512_castps512_ps256(v), _mm512_castps512_ps256(hi)));
+}
+
+__attribute__((target("avx512f,avx2,fma"))) void gemv_avx512(int rows, int cols, const double *a, std::ptrdiff_t lda,
+                                                    const double *x, double *y)
+{
+    int k = 0;
+    for (; k + 4 <= rows; k += 4)
+    {
+        const double *r0 = a + k * lda, *r1 = r0 + lda, *r2 = r1 + lda, *r3 = r2 + lda;
+        __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd(), s2 = _mm512_setzero_pd(), s3 = _mm512_setzero_pd();
+        int i = 0;
+        for (; i + 8 <= cols; i += 8)
+        {
+            __m512d xv = _mm512_loadu_pd(x + i);
+            s0 = _mm512_fmadd_pd(_mm512_loadu_pd(r0 + i), xv, s0);
+            s1 = _mm512_fmadd_pd(_mm512_loadu_pd(r1 + i), xv, s1);
+            s2 = _mm512_fmadd_pd(_mm512_loadu_pd(r2 + i), xv, s2);
+            s3 = _mm512_fmadd_pd(_mm512_loadu_pd(r3 + i), xv, s3);
+        }
+        if (i < cols)
+        {
+            __mmask8 m = static_cast<__mmask8>((1u << (cols - i)) - 1);
+            __m512d xv = _mm512_maskz_loadu_pd(m, x + i);
+            s0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, r0 + i), xv, s0);
+            s1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, r1 + i), xv, s1);
+            s2 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, r2 + i), xv, s2);
+            s3 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, r3 + i), xv, s3);
+        }
+        y[k] = hsum_avx512(s0);
+        y[k + 1] = hsum_avx512(s1);
+        y[k + 2] = hsum_avx512(s2);
+        y[k + 3] = hsum_avx512(s3);
+    }
+    for (; k < rows; k++)
+    {
+        const double *r0 = a + k * lda;
+        __m512d s0 = _mm512_setzero_pd();
+        int i = 0;
+        for (; i + 8 <= cols; i += 8)
+            s0 = _mm512_fmadd_pd(_mm512_loadu_pd(r0 + i), _mm512_loadu_pd(x + i), s0);
+        if (i < cols)
+        {
+            __mmask8 m = static_cast<__mmask8>((1u << (cols - i)) - 1);
+            s0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, r0 + i), _mm512_maskz_loadu_pd(m, x + i), s0);
+        }
+        y[k] = hsum_avx512(s0);
+    }
+}
+
+__attribute__((target("avx512f,avx2,fma"))) void gemv_avx512(int rows, int cols, const float *a, std::ptrdiff_t lda,
+                                                    const float *x, float *y)
+{
+    int k = 0;
+    for (; k + 4 <= rows; k += 4)
+    {
+        const float *r0 = a + k * lda, *r1 = r0 + lda, *r2 = r1 + lda, *r3 = r2 + lda;
+        __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps(), s2 = _mm512_setzero_ps(), s3 = _mm512_setzero_ps();
+        int i = 0;
+        for (; i + 16 <= cols; i += 16)
+        {
+            __m512 xv = _mm512_loadu_ps(x + i);
+            s0 = _mm512_fmadd_ps(_mm512_loadu_ps(r0 + i), xv, s0);
+            s1 = _mm512_fmadd_ps(_mm512_loadu_ps(r1 + i), xv, s1);
+            s2 = _mm512_fmadd_ps(_mm512_loadu_ps(r2 + i), xv, s2);
+            s3 = _mm512_fmadd_ps(_mm512_loadu_ps(r3 + i), xv, s3);
+        }
+        if (i < cols)
+        {
+            __mmask16 m = static_cast<__mmask16>((1u << (cols - i)) - 1);
+            __m512 xv = _mm512_maskz_loadu_ps(m, x + i);
+            s0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, r0 + i), xv, s0);
+            s1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, r1 + i), xv, s1);
+            s2 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, r2 + i), xv, s2);
+            s3 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, r3 + i), xv, s3);
+        }
+        y[k] = hsum_avx512(s0);
+        y[k + 1] = hsum_avx512(s1);
+        y[k + 2] = hsum_avx512(s2);
+        y[k + 3] = hsum_avx512(s3);
+    }
+    for (; k < rows; k++)
+    {
+        const float *r0 = a + k * lda;
+        __m512 s0 = _mm512_setzero_ps();
+        int i = 0;
+        for (; i + 16 <= cols; i += 16)
+            s0 = _mm512_fmadd_ps(_mm512_loadu_ps(r0 + i), _mm512_loadu_ps(x + i), s0);
+        if (i < cols)
+        {
+            __mmask16 m = static_cast<__mmask16>((1u << (cols - i)) - 1);
+            s0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, r0 + i), _mm512_maskz_loadu_ps(m, x + i), s0);
+        }
+        y[k] = hsum_avx512(s0);
+    }
+}
+
+__attribute__((target("avx512f,avx2,fma"))) void gemv_t_avx512(int rows, int cols, const double *a, std::ptrdiff_t lda,
+                                                               const double *x, double *y)
+{
+    int vec_cols = cols - cols % 8;
+    for (int j0 = 0; j0 < vec_cols; j0 += gemv_t_block)
+    {
+        int j1 = std::min(j0 + gemv_t_block, vec_cols);
+        for (int i = j0; i < j1; i += 8)
+            _mm512_storeu_pd(y + i, _mm512_setzero_pd());
+
+        int k = 0;
+        for (; k + 4 <= rows; k += 4)
+        {
+            const double *r0 = a + k * lda, *r1 = r0 + lda, *r2 = r1 + lda, *r3 = r2 + lda;
+            __m512d x0 = _mm512_set1_pd(x[k]), x1 = _mm512_set1_pd(x[k + 1]);
+            __m512d x2 = _mm512_set1_pd(x[k + 2]), x3 = _mm512_set1_pd(x[k + 3]);
+            for (int i = j0; i < j1; i += 8)
+            {
+                __m512d acc = _mm512_loadu_pd(y + i);
+                acc = _mm512_fmadd_pd(_mm512_loadu_pd(r0 + i), x0, acc);
+                acc = _mm512_fmadd_pd(_mm512_loadu_pd(r1 + i), x1, acc);
+                acc = _mm512_fmadd_pd(_mm512_loadu_pd(r2 + i), x2, acc);
+                acc = _mm512_fmadd_pd(_mm512_loadu_pd(r3 + i), x3, acc);
+                _mm512_storeu_pd(y + i, acc);
+            }
+        }
+        for (; k < rows; k++)
+        {
+            const double *r0 = a + k * lda;
+            __m512d x0 = _mm512_set1_pd(x[k]);
+            for (int i = j0; i < j1; i += 8)
+                _mm512_storeu_pd(y + i, _mm512_fmadd_pd(_mm512_loadu_pd(r0 + i), x0, _mm512_loadu_pd(y + i)));
+        }
+    }
+    gemv_t_columns(rows, vec_cols, cols, a, lda, x, y);
+}
+
+__attribute__((target("avx512f,avx2,fma"))) void gemv_t_avx512(int rows, int cols, const float *a, std::ptrdiff_t lda,
+                                                               const float *x, float *y)
+{
+    int vec_cols = cols - cols % 16;
+    for (int j0 = 0; j0 < vec_cols; j0 += gemv_t_block)
+    {
+        int j1 = std::min(j0 + gemv_t_block, vec_cols);
+        for (int i = j0; i < j1; i += 16)
+            _mm512_storeu_ps(y + i, _mm512_setzero_ps());
+
+        int k = 0;
+        for (; k + 4 <= rows; k += 4)
+        {
+            const float *r0 = a + k * lda, *r1 = r0 + lda, *r2 = r1 + lda, *r3 = r2 + lda;
+            __m512 x0 = _mm512_set1_ps(x[k]), x1 = _mm512_set1_ps(x[k + 1]);
+            __m512 x2 = _mm512_set1_ps(x[k + 2]), x3 = _mm512_set1_ps(x[k + 3]);
+            for (int i = j0; i < j1; i += 16)
+            {
+                __m512 acc = _mm512_loadu_ps(y + i);
+                acc = _mm512_fmadd_ps(_mm512_loadu_ps(r0 + i), x0, acc);
+                acc = _mm512_fmadd_ps(_mm512_loadu_ps(r1 + i), x1, acc);
+                acc = _mm512_fmadd_ps(_mm512_loadu_ps(r2 + i), x2, acc);
+                acc = _mm512_fmadd_ps(_mm512_loadu_ps(r3 + i), x3, acc);
+                _mm512_storeu_ps(y + i, acc);
+            }
+        }
+        for (; k < rows; k++)
+        {
+            const float *r0 = a + k * lda;
+            __m512 x0 = _mm512_set1_ps(x[k]);
+            for (int i = j0; i < j1; i += 16)
+                _mm512_storeu_ps(y + i, _mm512_fmadd_ps(_mm512_loadu_ps(r0 + i), x0, _mm512_loadu_ps(y + i)));
+        }
+    }
+    gemv_t_columns(rows, vec_cols, cols, a, lda, x, y);
+}
+
+__attribute__((target("avx512f,avx2,fma"))) void vadd_avx512(const double *a, const double *b, double *out, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(out + i, _mm512_add_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+    vadd_scalar(a + i, b + i, out + i, n - i);
+}
+
+__attribute__((target("avx512f,avx2,fma"))) void vadd_avx512(const float *a, const float *b, float *out, int n)
+{
+    int i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(out + i, _mm512_add_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+    vadd_scalar(a + i, b + i, out + i, n - i);
+}
+
+#endif
+
+/**
+ * @brief Kernel table for one element type, filled once for the active instruction set.
+ */
+template <typename T>
+struct kernels
+{
+    void (*gemv)(int, int, const T *, std::ptrdiff_t, const T *, T *);
+    void (*gemv_t)(int, int, const T *, std::ptrdiff_t, const T *, T *);
+    void (*vadd)(const T *, const T *, T *, int);
+    void (*tile)(int, const T *, const T *, T *, std::ptrdiff_t, std::ptrdiff_t, int, int);
+    void (*momentum)(int, T *, const T *, T *, T, T, T, T);
+    void (*adaptive)(int, T *, const T *, T *, T *, T, T, T, T);
+    void (*exp)(int, const T *, T *, int);
+    void (*sigmoid)(int, const T *, T *, int);
+    void (*tanh)(int, const T *, T *, int);
+};
+
+isa detect_isa()
+{
+    isa best = isa::scalar;
+
+#if PHOENIX_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        best = isa::sse2;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        best = isa::avx2;
+    if (__builtin_cpu_supports("avx512f"))
+        best = isa::avx512;
+#endif
+
+    /*allow the user to pin a narrower instruction set*/
+    const char *env = std::getenv("PHOENIX_SIMD");
+    if (env != nullptr)
+    {
+        isa forced = best;
+        if (std::strcmp(env, "scalar") == 0)
+            forced = isa::scalar;
+        else if (std::strcmp(env, "sse2") == 0)
+            forced = isa::sse2;
+        else if (std::strcmp(env, "avx2") == 0)
+            forced = isa::avx2;
+        else if (std::strcmp(env, "avx512") == 0)
+            forced = isa::avx512;
+
+        if (forced < best)
+            best = forced;
+    }
+
+    return best;
+}
+
+template <typename T>
+kernels<T> select_kernels(isa set)
+{
+    kernels<T> table{gemv_scalar<T>, gemv_t_scalar<T>, vadd_scalar<T>, gemm_tile_scalar<T>,
+                     momentum_scalar<T>, adaptive_scalar<T>,
+                     by_degree<T, vexp_scalar<degree_high, T>, vexp_scalar<degree_fast, T>>,
+                     by_degree<T, vsigmoid_scalar<degree_high, T>, vsigmoid_scalar<degree_fast, T>>,
+                     by_degree<T, vtanh_scalar<degree_high, T>, vtanh_scalar<degree_fast, T>>};
+
+#if PHOENIX_SIMD_X86
+    switch (set)
+    {
+    case isa::avx512:
+        table.gemv = gemv_avx512;
+        table.gemv_t = gemv_t_avx512;
+        table.vadd = vadd_avx512;
+        table.tile = gemm_tile_avx2;
+        table.momentum = momentum_avx2;
+        table.adaptive = adaptive_avx2;
+        table.exp = by_degree<T, vexp_avx2<degree_high>, vexp_avx2<degree_fast>>;
+        table.sigmoid = by_degree<T, vsigmoid_avx2<degree_high>, vsigmoid_avx2<degree_fast>>;
+        table.tanh = by_degree<T, vtanh_avx2<degree_high>, vtanh_avx2<degree_fast>>;
+        break;
+    case isa::avx2:
+        table.gemv = gemv_avx2;
+        table.gemv_t = gemv_t_avx2;
+        table.vadd = vadd_avx2;
+        table.tile = gemm_tile_avx2;
+        table.momentum = momentum_avx2;
+        table.adaptive = adaptive_avx2;
+        table.exp = by_degree<T, vexp_avx2<degree_high>, vexp_avx2<degree_fast>>;
+        table.sigmoid = by_degree<T, vsigmoid_avx2<degree_high>, vsigmoid_avx2<degree_fast>>;
+        table.tanh = by_degree<T, vtanh_avx2<degree_high>, vtanh_avx2<degree_fast>>;
+        break;
+    case isa::sse2:
+        table.gemv = gemv_sse2;
+        table.gemv_t = gemv_t_sse2;
+        table.vadd = vadd_sse2;
+        break;
+    default:
+        break;
+    }
+#endif
+
+    return table;
+}
+
+using gemv_s8_kernel = void (*)(int, int, const std::int8_t *, std::ptrdiff_t, const std::int8_t *, std::int32_t *);
+
+gemv_s8_kernel select_gemv_s8(isa set)
+{
+#if PHOENIX_SIMD_X86
+    if (set >= isa::avx2)
+        return gemv_s8_avx2;
+#endif
+    return gemv_s8_scalar;
+}
+
+using philox_kernel = void (*)(std::uint64_t, std::uint64_t, std::uint64_t, int, std::uint32_t *);
+
+philox_kernel select_philox(isa set)
+{
+#if PHOENIX_SIMD_X86
+    if (set >= isa::avx2)
+        return philox_avx2;
+#endif
+    return philox_scalar;
+}
+
+template <typename T>
+const kernels<T> &table()
+{
+    static const kernels<T> k = select_kernels<T>(active_isa());
+    return k;
+}
+
+}
+
+isa active_isa()
+{
+    static const isa set = detect_isa();
+    return set;
+}
+
+const char *isa_name(isa set)
+{
+    switch (set)
+    {
+    case isa::sse2:
+        return "sse2";
+    case isa::avx2:
+        return "avx2";
+    case isa::avx512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+void gemv(int rows, int cols, const double *a, std::ptrdiff_t lda, const double *x, double *y)
+{
+    table<double>().gemv(rows, cols, a, lda, x, y);
+}
+
+void gemv(int rows, int cols, const float *a, std::ptrdiff_t lda, const float *x, float *y)
+{
+    table<float>().gemv(rows, cols, a, lda, x, y);
+}
+
+void gemv_transposed(int rows, int cols, const double *a, std::ptrdiff_t lda, const double *x, double *y)
+{
+    table<double>().gemv_t(rows, cols, a, lda, x, y);
+}
+
+void gemv_transposed(int rows, int cols, const float *a, std::ptrdiff_t lda, const float *x, float *y)
+{
+    table<float>().gemv_t(rows, cols, a, lda, x, y);
+}
+
+void gemm_tile(int kc, const double *a, const double *b, double *c, std::ptrdiff_t rsc, std::ptrdiff_t csc, int mr, int nr)
+{
+    table<double>().tile(kc, a, b, c, rsc, csc, mr, nr);
+}
+
+void gemm_tile(int kc, const float *a, const float *b, float *c, std::ptrdiff_t rsc, std::ptrdiff_t csc, int mr, int nr)
+{
+    table<float>().tile(kc, a, b, c, rsc, csc, mr, nr);
+}
+
+void momentum_step(int n, double *p, const double *g, double *v, double mu, double rate, double a, double c)
+{
+    table<double>().momentum(n, p, g, v, mu, rate, a, c);
+}
+
+void momentum_step(int n, float *p, const float *g, float *v, float mu, float rate, float a, float c)
+{
+    table<float>().momentum(n, p, g, v, mu, rate, a, c);
+}
+
+void adaptive_step(int n, double *p, const double *g, double *m, double *v, double b1, double b2, double rate, double eps)
+{
+    table<double>().adaptive(n, p, g, m, v, b1, b2, rate, eps);
+}
+
+void adaptive_step(int n, float *p, const float *g, float *m, float *v, float b1, float b2, float rate, float eps)
+{
+    table<float>().adaptive(n, p, g, m, v, b1, b2, rate, eps);
+}
+
+namespace {
+
+int approximation_degree(accuracy acc)
+{
+    return acc == accuracy::fast ? degree_fast : degree_high;
+}
+
+}
+
+void vexp(int n, const double *x, double *y, accuracy acc)
+{
+    if (acc == accuracy::exact)
+    {
+        for (int i = 0; i < n; i++)
+            y[i] = std::exp(x[i]);
+        return;
+    }
+    table<double>().exp(n, x, y, approximation_degree(acc));
+}
+
+void vexp(int n, const float *x, float *y, accuracy acc)
+{
+    if (acc == accuracy::exact)
+    {
+        for (int i = 0; i < n; i++)
+            y[i] = std::exp(x[i]);
+        return;
+    }
+    table<float>().exp(n, x, y, approximation_degree(acc));
+}
+
+void vsigmoid(int n, const double *x, double *y, accuracy acc)
+{
+    if (acc == accuracy::exact)
+    {
+        for (int i = 0; i < n; i++)
+            y[i] = 1 / (1 + std::exp(-x[i]));
+        return;
+    }
+    table<double>().sigmoid(n, x, y, approximation_degree(acc));
+}
+
+void vsigmoid(int n, const float *x, float *y, accuracy acc)
+{
+    if (acc == accuracy::exact)
+    {
+        for (int i = 0; i < n; i++)
+            y[i] = 1.0f / (1.0f + std::exp(-x[i]));
+        return;
+    }
+    table<float>().sigmoid(n, x, y, approximation_degree(acc));
+}
+
+void vtanh(int n, const double *x, double *y, accuracy acc)
+{
+    if (acc == accuracy::exact)
+    {
+        for (int i = 0; i < n; i++)
+            y[i] = std::tanh(x[i]);
+        return;
+    }
+    table<double>().tanh(n, x, y, approximation_degree(acc));
+}
+
+void vtanh(int n, const float *x, float *y, accuracy acc)
+{
+    if (acc == accuracy::exact)
+    {
+        for (int i = 0; i < n; i++)
+            y[i] = std::tanh(x[i]);
+        return;
+    }
+    table<float>().tanh(n, x, y, approximation_degree(acc));
+}
+
+double dot(const double *a, const double *b, int n)
+{
+    double result;
+    table<double>().gemv(1, n, a, n, b, &result);
+    return result;
+}
+
+float dot(const float *a, const float *b, int n)
+{
+    float result;
+    table<float>().gemv(1, n, a, n, b, &result);
+    return result;
+}
+
+void gemv(int rows, int cols, const std::int8_t *a, std::ptrdiff_t lda, const std::int8_t *x, std::int32_t *y)
+{
+    static const gemv_s8_kernel kernel = select_gemv_s8(active_isa());
+    kernel(rows, cols, a, lda, x, y);
+}
+
+void philox(std::uint64_t counter, std::uint64_t stream, std::uint64_t key, int blocks, std::uint32_t *out)
+{
+    static const philox_kernel kernel = select_philox(active_isa());
+    kernel(counter, stream, key, blocks, out);
+}
+
+void vadd(const double *a, const double *b, double *out, int n)
+{
+    table<double>().vadd(a, b, out, n);
+}
+
+void vadd(const float *a, const float *b, float *out, int n)
+{
+    table<float>().vadd(a, b, out, n);
+}
+
+}
+}
@@ -0,0 +1,160 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace phoenix {
+
+namespace {
+
+/*set while the current thread executes a loop body, nested loops then run inline*/
+thread_local bool inside_loop = false;
+
+std::size_t default_workers()
+{
+    const char *env = std::getenv("PHOENIX_NUM_THREADS");
+    if (env != nullptr)
+    {
+        int threads = std::atoi(env);
+        if (threads > 0)
+            return static_cast<std::size_t>(threads - 1);
+    }
+
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 1 ? hw - 1 : 0;
+}
+
+}
+
+ThreadPool &ThreadPool::instance()
+{
+    static ThreadPool pool(default_workers());
+    return pool;
+}
+
+ThreadPool::ThreadPool(std::size_t workers)
+{
+    jobs_.reserve(16);
+    workers_.reserve(workers);
+    for (std::size_t i = 0; i < workers; i++)
+    {
+        workers_.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+
+    for (auto &worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::run_chunks(Job &job)
+{
+    bool nested = inside_loop;
+    inside_loop = true;
+
+    std::size_t chunk;
+    while ((chunk = job.next.fetch_add(1)) < job.chunks)
+    {
+        std::size_t first = job.begin + chunk * job.grain;
+        std::size_t last = std::min(job.end, first + job.grain);
+        try
+        {
+            job.body.invoke(job.body.ctx, first, last);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!job.error)
+                job.error = std::current_exception();
+        }
+    }
+
+    inside_loop = nested;
+}
+
+void ThreadPool::retire(Job *job)
+{
+    auto it = std::find(jobs_.begin(), jobs_.end(), job);
+    if (it != jobs_.end())
+        jobs_.erase(it);
+}
+
+void ThreadPool::worker_loop()
+{
+    for (;;)
+    {
+        Job *job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+            if (stop_)
+                return;
+
+            job = jobs_.front();
+            ++job->active;
+        }
+
+        run_chunks(*job);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            /*every chunk is handed out, stop other workers from picking the job up again*/
+            retire(job);
+            if (--job->active == 0)
+                done_cv_.notify_all();
+        }
+    }
+}
+
+void ThreadPool::run(std::size_t begin, std::size_t end, std::size_t grain, Task body)
+{
+    if (end <= begin)
+        return;
+
+    grain = std::max<std::size_t>(grain, 1);
+    std::size_t chunks = (end - begin + grain - 1) / grain;
+
+    if (chunks == 1 || workers_.empty() || inside_loop)
+    {
+        body.invoke(body.ctx, begin, end);
+        return;
+    }
+
+    Job job;
+    job.body = body;
+    job.begin = begin;
+    job.end = end;
+    job.grain = grain;
+    job.chunks = chunks;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(&job);
+    }
+    if (chunks > 2)
+        work_cv_.notify_all();
+    else
+        work_cv_.notify_one();
+
+    run_chunks(job);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        retire(&job);
+        done_cv_.wait(lock, [&job] { return job.active == 0; });
+    }
+
+    if (job.error)
+        std::rethrow_exception(job.error);
+}
+
+}